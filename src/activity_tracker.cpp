@@ -1,4 +1,3 @@
-#include "rand_maths.h"
 #include "activity_tracker.h"
 
 using namespace retrocombinator;
@@ -16,12 +15,13 @@ bool ActivityTracker::is_critical(size_type n) const
         (n < sequence_length && (n+critical_region_length) >= sequence_length);
 }
 
-bool ActivityTracker::check_activity(size_type num_critical_mutations) const
+bool ActivityTracker::check_activity(size_type num_critical_mutations,
+                                     RandMaths& rng) const
 {
     // P(staying active N mutations) = (1-x)^N
     double staying_alive = pow(1-inactive_probability, num_critical_mutations);
 
     // 0^0 case
     if (num_critical_mutations == 0) return true;
-    return RNG.test_event(staying_alive);
+    return rng.test_event(staying_alive);
 }
@@ -6,6 +6,7 @@
 #define ACTIVITY_TRACKER_H
 
 #include "constants.h"
+#include "rand_maths.h"
 
 namespace retrocombinator
 {
@@ -51,8 +52,10 @@ namespace retrocombinator
 
         /** Has a sequence with a given number of mutations to the critical
          *  region become inactive?
+         *  Random numbers are drawn from \a rng.
          */
-        bool check_activity(size_type num_critical_mutations) const;
+        bool check_activity(size_type num_critical_mutations,
+                            RandMaths& rng) const;
 
     };
 }
@@ -0,0 +1,49 @@
+#include "alias_table.h"
+
+using namespace retrocombinator;
+
+AliasTable::AliasTable(const double weights[], size_type num_events) :
+    prob(num_events, 1.0), alias(num_events, 0)
+{
+    if (num_events == 0) {
+        throw Exception("Number of events needs to be strictly positive");
+    }
+    double total = 0;
+    for (size_type i=0; i<num_events; ++i)
+    {
+        if (weights[i] < 0) {
+            throw Exception("Event probabilities cannot be negative");
+        }
+        total += weights[i];
+    }
+    if (total <= 0) {
+        throw Exception("Event probabilities add up to 0");
+    }
+
+    // Scale so that a bin that is exactly full has probability 1, and sort
+    // the bins into those that are underfull and those that are overfull
+    std::vector<double> scaled(num_events);
+    std::vector<size_type> small, large;
+    for (size_type i=0; i<num_events; ++i)
+    {
+        alias[i] = i;
+        scaled[i] = weights[i] * num_events / total;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+
+    // Top up each underfull bin with an overfull one
+    while (!small.empty() && !large.empty())
+    {
+        size_type s = small.back(); small.pop_back();
+        size_type l = large.back();
+        prob[s] = scaled[s];
+        alias[s] = l;
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // Whatever is left is full, up to rounding errors (prob is already 1)
+}
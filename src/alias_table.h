@@ -0,0 +1,58 @@
+/**
+ * @file
+ *
+ * \brief For the AliasTable class, which samples from a fixed discrete
+ * distribution in constant time
+ */
+#ifndef ALIAS_TABLE_H
+#define ALIAS_TABLE_H
+
+#include "constants.h"
+
+#include <vector>
+
+namespace retrocombinator
+{
+    /** Walker's alias method for sampling from a discrete distribution.
+     *
+     *  The distribution is split into as many equal-sized bins as there are
+     *  events, and each bin holds at most two events: its own, and an alias.
+     *  Sampling picks a bin and then one of its two events, which takes one
+     *  uniform value and one comparison, however many events there are.
+     *  Building the table (Vose's method) takes linear time, so this is meant
+     *  for distributions that are sampled from many times.
+     */
+    class AliasTable
+    {
+    private:
+        /// For each bin, the probability of picking its own event
+        std::vector<double> prob;
+        /// For each bin, the event picked otherwise
+        std::vector<size_type> alias;
+
+    public:
+        /// An empty table, which cannot be sampled from
+        AliasTable() {}
+
+        /** Builds a table for events with the given *relative*
+         *  probabilities.
+         *  Throws an exception if they are negative or add up to 0.
+         */
+        AliasTable(const double weights[], size_type num_events);
+
+        /// Returns the number of events
+        size_type size() const { return prob.size(); }
+
+        /** Returns the event corresponding to the uniform value \a u in
+         *  [0, 1).
+         */
+        size_type sample(double u) const
+        {
+            double x = u * prob.size();
+            size_type bin = static_cast<size_type>(x);
+            return (x - bin < prob[bin]) ? bin : alias[bin];
+        }
+    };
+}
+
+#endif // ALIAS_TABLE_H
@@ -0,0 +1,153 @@
+/**
+ * @file
+ *
+ * \brief For the BKTree class, an index of items under an integer metric
+ */
+#ifndef BK_TREE_H
+#define BK_TREE_H
+
+#include "constants.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace retrocombinator
+{
+    /** A Burkhard-Keller tree: an index over items with an integer distance
+     *  between them that obeys the triangle inequality, such as the Hamming
+     *  distance between sequences.
+     *
+     *  Items are identified by their index, and the tree never sees the items
+     *  themselves, only distances from a functor. Each node holds one item,
+     *  and its children are keyed by their distance to it. A search for items
+     *  within \c d of a query that is \c q away from a node then only needs
+     *  the children with keys in <tt>[q-d, q+d]</tt>.
+     *
+     *  The distance functors are called as <tt>dist(item, max_d)</tt>, and
+     *  must return the distance to \c item if it is at most \c max_d, and
+     *  otherwise any value greater than \c max_d (so they can stop early).
+     */
+    class BKTree
+    {
+    private:
+        /// One item in the tree
+        struct Node
+        {
+            /// The index of the item
+            size_type item;
+            /// Children (by node index), keyed by their distance to the item
+            std::map<size_type, size_type> children;
+
+            explicit Node(size_type item) : item(item) {}
+        };
+
+        /// All the nodes, the root first
+        std::vector<Node> nodes;
+
+        /** Visits the nodes that may hold items within \a max_d of a query,
+         *  calling <tt>found(item)</tt> for each item that is, until it
+         *  returns true.
+         *  Returns true if the search was stopped.
+         */
+        template <typename Distance, typename Found>
+        bool search(size_type max_d, Distance dist, Found found) const;
+
+    public:
+        /// Number of items in the tree
+        size_type size() const { return nodes.size(); }
+
+        /// Removes all items
+        void clear() { nodes.clear(); }
+
+        /** Adds the item \a item.
+         *  <tt>dist(k, max_d)</tt> gives the distance between \a item and
+         *  item \c k already in the tree.
+         */
+        template <typename Distance>
+        void insert(size_type item, Distance dist);
+
+        /** Is there any item within \a max_d of a query (inclusive)?
+         *  <tt>dist(k, max_d)</tt> gives the distance between the query and
+         *  item \c k.
+         */
+        template <typename Distance>
+        bool any_within(size_type max_d, Distance dist) const
+        {
+            return search(max_d, dist, [](size_type) { return true; });
+        }
+
+        /** All items within \a max_d of a query (inclusive), in increasing
+         *  order.
+         *  <tt>dist(k, max_d)</tt> gives the distance between the query and
+         *  item \c k.
+         */
+        template <typename Distance>
+        std::vector<size_type> all_within(size_type max_d, Distance dist) const
+        {
+            std::vector<size_type> items;
+            search(max_d, dist,
+                   [&items](size_type k) { items.push_back(k); return false; });
+            std::sort(items.begin(), items.end());
+            return items;
+        }
+    };
+
+    template <typename Distance>
+    void BKTree::insert(size_type item, Distance dist)
+    {
+        if (nodes.empty())
+        {
+            nodes.emplace_back(item);
+            return;
+        }
+        size_type n = 0;
+        while (true)
+        {
+            size_type d = dist(nodes[n].item,
+                               std::numeric_limits<size_type>::max());
+            auto child = nodes[n].children.find(d);
+            if (child == nodes[n].children.end())
+            {
+                nodes[n].children[d] = nodes.size();
+                nodes.emplace_back(item);
+                return;
+            }
+            n = child->second;
+        }
+    }
+
+    template <typename Distance, typename Found>
+    bool BKTree::search(size_type max_d, Distance dist, Found found) const
+    {
+        if (nodes.empty()) { return false; }
+        std::vector<size_type> to_visit { 0 };
+        while (!to_visit.empty())
+        {
+            const Node& node = nodes[to_visit.back()];
+            to_visit.pop_back();
+
+            // past this, the distance to the query is too large for any of
+            // the children to be close enough
+            size_type bound = max_d;
+            if (!node.children.empty())
+            {
+                bound += node.children.rbegin()->first;
+            }
+            size_type d = dist(node.item, bound);
+            if (d <= max_d && found(node.item)) { return true; }
+            if (d > bound) { continue; }
+
+            auto beg = node.children.lower_bound(d > max_d ? d - max_d : 0);
+            auto end = node.children.upper_bound(d + max_d);
+            for (auto it = beg; it != end; ++it)
+            {
+                to_visit.push_back(it->second);
+            }
+        }
+        return false;
+    }
+}
+
+#endif // BK_TREE_H
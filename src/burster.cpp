@@ -1,56 +1,112 @@
 #include "burster.h"
-#include "rand_maths.h"
+
+#include <cmath>
 
 
 using namespace retrocombinator;
 
+namespace
+{
+    /** Partners are drawn at random until more than this many draws have
+     *  been rejected for every one accepted, after which the similar
+     *  sequences are all found at once.
+     */
+    const size_type MAX_REJECTIONS_PER_ACCEPT = 8;
+}
+
 Burster::Burster(double burst_probability, double burst_mean,
                  size_type max_total_copies,
                  double recomb_mean, double recomb_similarity):
     burst_probability(burst_probability), burst_mean(burst_mean),
     max_total_copies(max_total_copies),
-    recomb_mean(recomb_mean), recomb_similarity(recomb_similarity)
+    recomb_mean(recomb_mean), recomb_similarity(recomb_similarity),
+    num_full_scans(0)
 {}
 
-void Burster::burst_sequences(sequence_list& pool) {
+void Burster::burst_sequences(sequence_list& pool, const RandMaths& rng,
+                              size_type timestep, DistanceMatrix* distances) {
 
+    num_full_scans = 0;
     if (pool.empty()) return;
 
     // 1) How many new sequences to make?
-    auto new_sequence_counts = get_new_sequence_counts(pool);
+    auto new_sequence_counts = get_new_sequence_counts(pool, rng, timestep);
 
+    auto pruning_rng = rng.stream(Consts::POOL_STREAM_TAG, timestep,
+                                  Consts::RAND_PRUNING);
     auto pruned_sequence_counts =
-        RNG.choose_items(new_sequence_counts, max_total_copies);
+        pruning_rng.choose_items(new_sequence_counts, max_total_copies);
 
-    // Store the last sequence we currently have
-    auto last_sequence = std::next(pool.end(), -1);
     const size_type N = pool.size();
 
-    sequence_list::iterator it, jt;
+    // The sequences from before the burst, which are the possible partners
+    std::vector<Sequence *> old_seqs;
+    old_seqs.reserve(N);
+    for (auto& seq : pool) { old_seqs.push_back(&seq); }
+
+    sequence_list::iterator it;
     size_type i, copy_num;
     std::vector<Sequence *> similar_seqs;
 
+    size_type max_recomb_d = 0;
+    bool can_recombine = get_max_recomb_distance(pool.front().get_length(),
+                                                 max_recomb_d);
+    auto similar = [distances, max_recomb_d](const Sequence& s1, const Sequence& s2)
+    {
+        return distances ? distances->get(s1, s2) <= max_recomb_d :
+                           within_distance(s1, s2, max_recomb_d);
+    };
+
     // 2a) Create new sequences based on bursting
     for (it = pool.begin(), i = 0; i < N; ++it, ++i) {
         // If this sequence burst
         if (pruned_sequence_counts[N +i] > 0) {
 
-            // Which sequences can it recombine with?
-            similar_seqs.clear();
-            for(jt = pool.begin(); jt != std::next(last_sequence); ++jt)
+            // Create the recombined sequences, each with a partner picked
+            // uniformly from the sequences it is similar enough to.
+            // Draws from all sequences that are rejected if they are not
+            // similar pick from the same distribution, and usually need only
+            // a few comparisons. When too many are rejected, we find all the
+            // similar sequences instead, and then pick from them.
+            auto recomb_rng = rng.stream(it->get_tag(), timestep,
+                                         Consts::RAND_RECOMBINATION);
+            size_type accepted = 0, rejected = 0;
+            bool scanned = !can_recombine;
+            if (scanned) { similar_seqs.clear(); }
+            for(copy_num = 0; copy_num < pruned_sequence_counts[N+i]; ++copy_num)
             {
-                if (1-((*it) % (*jt)) > recomb_similarity)
+                Sequence * partner = nullptr;
+                while (!partner && !scanned)
                 {
-                    similar_seqs.push_back(&*jt);
+                    Sequence * candidate = old_seqs[recomb_rng.rand_int(0, N)];
+                    if (similar(*it, *candidate))
+                    {
+                        partner = candidate;
+                        ++accepted;
+                    }
+                    else if (++rejected > MAX_REJECTIONS_PER_ACCEPT * (accepted + 1) ||
+                             accepted + rejected >= N)
+                    {
+                        similar_seqs.clear();
+                        for (auto seq : old_seqs)
+                        {
+                            if (similar(*it, *seq))
+                            {
+                                similar_seqs.push_back(seq);
+                            }
+                        }
+                        scanned = true;
+                        ++num_full_scans;
+                    }
                 }
-            }
-
-            // Create the recombined sequences
-            for(copy_num = 0; copy_num < pruned_sequence_counts[N+i]; ++copy_num)
-            {
-                auto new_seq = RNG.rand_int(0, similar_seqs.size());
-                pool.emplace_back(*it, *similar_seqs[new_seq],
-                    recomb_mean != 0 ? RNG.rand_poisson(recomb_mean) : 0);
+                if (!partner)
+                {
+                    partner = similar_seqs[recomb_rng.rand_int(0, similar_seqs.size())];
+                }
+                pool.emplace_back(*it, *partner,
+                    recomb_mean != 0 ? recomb_rng.rand_poisson(recomb_mean) : 0,
+                    recomb_rng);
+                if (distances) { distances->add_from(pool.back(), *it); }
             }
         }
     }
@@ -59,13 +115,33 @@ void Burster::burst_sequences(sequence_list& pool) {
     for (it = pool.begin(), i = 0; i < N; ++i) {
         // If this sequence was chosen
         if (pruned_sequence_counts[i] >= 1) { ++it;}
-        else { it = pool.erase(it); }
+        else {
+            if (distances) { distances->remove(*it); }
+            it = pool.erase(it);
+        }
     }
 
 }
 
+bool Burster::get_max_recomb_distance(size_type n, size_type& max_d) const
+{
+    // Similarity is 1-(d/n), so start from the real-valued bound and step down
+    // until the comparison (done exactly as for the similarity) holds
+    double bound = std::floor((1.0 - recomb_similarity) * n) + 1;
+    long d = long(std::min(double(n), std::max(bound, 0.0)));
+    for (; d >= 0; --d)
+    {
+        if (1-(double(d)/double(n)) > recomb_similarity)
+        {
+            max_d = d;
+            return true;
+        }
+    }
+    return false;
+}
+
 std::vector<size_type> Burster::get_new_sequence_counts(
-        const sequence_list& pool)
+        const sequence_list& pool, const RandMaths& rng, size_type timestep)
 {
     const size_type N = pool.size();
     // What are we trying to burst the N sequences into?
@@ -78,8 +154,10 @@ std::vector<size_type> Burster::get_new_sequence_counts(
     size_type i;
     for (it = pool.begin(), i = 0; i < N; ++it, ++i) {
         new_sequence_counts[i] = 1;
-        if (it->is_active() && RNG.test_event(burst_probability)) {
-            new_sequence_counts[N + i] = RNG.rand_poisson(burst_mean);
+        if (!it->is_active()) { continue; }
+        auto burst_rng = rng.stream(it->get_tag(), timestep, Consts::RAND_BURST);
+        if (burst_rng.test_event(burst_probability)) {
+            new_sequence_counts[N + i] = burst_rng.rand_poisson(burst_mean);
         }
     }
 
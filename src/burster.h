@@ -6,6 +6,8 @@
 #define BURSTER_H
 
 #include "constants.h"
+#include "distance_matrix.h"
+#include "rand_maths.h"
 #include "sequence.h"
 
 namespace retrocombinator
@@ -37,13 +39,27 @@ namespace retrocombinator
          */
         const double recomb_similarity;
 
+        /** How many bursting sequences, in the last call to
+         *  burst_sequences(), had their partners picked after comparing them
+         *  against every sequence, as too many random partners were rejected
+         */
+        size_type num_full_scans;
+
         /**
          * What are we trying to burst the N sequences into?
          * - The first N values are 1, representing the sequences themselves
          * - Value (N+i) represents the number of new sequences created by
          *   bursting sequence i
          */
-        std::vector<size_type> get_new_sequence_counts(const sequence_list& pool);
+        std::vector<size_type> get_new_sequence_counts(const sequence_list& pool,
+                                                       const RandMaths& rng,
+                                                       size_type timestep);
+
+        /** What is the largest distance between two sequences of length \a n
+         *  for which their similarity is greater than \a recomb_similarity?
+         *  Returns false if no distance is small enough.
+         */
+        bool get_max_recomb_distance(size_type n, size_type& max_d) const;
 
     public:
         /** Constructs a burster with input information about how often
@@ -56,8 +72,22 @@ namespace retrocombinator
         /** How the sequences burst after a timestep in the simulation.
          *  Input is a list of active sequences that are capable of bursting.
          *  Output is a list of how much each sequence is present
+         *
+         *  Random numbers are drawn from streams of \a rng for this \a
+         *  timestep, one for each sequence that bursts and one for pruning,
+         *  so they do not depend on the order in which sequences are looked at.
+         *
+         *  The similarity of sequences is read from \a distances if it is
+         *  given, in which case it must hold every sequence of the pool, and
+         *  it is kept up to date as sequences are added and removed.
+         *  Otherwise sequences are compared directly, stopping once they are
+         *  too different to recombine.
          */
-        void burst_sequences(sequence_list& pool);
+        void burst_sequences(sequence_list& pool, const RandMaths& rng,
+                             size_type timestep, DistanceMatrix* distances);
+
+        /// \copydoc Burster::num_full_scans
+        size_type get_num_full_scans() const { return num_full_scans; }
     };
 }
 
@@ -0,0 +1,40 @@
+#include "condensed_matrix.h"
+
+using namespace retrocombinator;
+
+CondensedMatrix::CondensedMatrix(size_type n, size_type max_value) :
+    n(0), wide(max_value > 0xFFFF)
+{
+    if (max_value > 0xFFFFFFFFULL) {
+        throw Exception("Distances are too large to be stored");
+    }
+    resize(n);
+}
+
+CondensedMatrix::CondensedMatrix(const dist_type& full) :
+    n(0), wide(false)
+{
+    for (size_type i=0; i<full.size(); ++i)
+    {
+        for (size_type j=i+1; j<full.size(); ++j)
+        {
+            if (full[i][j] > 0xFFFF) { wide = true; }
+        }
+    }
+    resize(full.size());
+    for (size_type i=0; i<n; ++i)
+    {
+        for (size_type j=i+1; j<n; ++j)
+        {
+            set(i, j, full[i][j]);
+        }
+    }
+}
+
+void CondensedMatrix::resize(size_type new_n)
+{
+    n = new_n;
+    size_type num_cells = n * (n > 0 ? n - 1 : 0) / 2;
+    if (wide) { wide_cells.resize(num_cells, 0); }
+    else { narrow_cells.resize(num_cells, 0); }
+}
@@ -0,0 +1,90 @@
+/**
+ * @file
+ *
+ * \brief For the CondensedMatrix class, a compact symmetric matrix of
+ * distances
+ */
+#ifndef CONDENSED_MATRIX_H
+#define CONDENSED_MATRIX_H
+
+#include "constants.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace retrocombinator
+{
+    /** A symmetric matrix of distances with 0 on the diagonal, such as the
+     *  distances between sequences.
+     *
+     *  Only the cells above the diagonal are stored, in one contiguous block,
+     *  and each cell is as narrow as the largest distance allows: 16 bits if
+     *  distances are at most 65535 (sequences up to that length), and 32 bits
+     *  otherwise. This takes an eighth (or a quarter) of the memory of a full
+     *  matrix of size_type.
+     *
+     *  Cells are laid out column by column, so the matrix can grow by a row
+     *  and column without moving the cells already stored.
+     */
+    class CondensedMatrix
+    {
+    private:
+        /// Number of rows (and columns)
+        size_type n;
+        /// Whether cells need 32 bits
+        bool wide;
+        /// Cells, when they fit in 16 bits
+        std::vector<std::uint16_t> narrow_cells;
+        /// Cells, when they need 32 bits
+        std::vector<std::uint32_t> wide_cells;
+
+        /// Where the cell for \a i, \a j (which must differ) is stored
+        static size_type index(size_type i, size_type j)
+        {
+            if (i > j) { std::swap(i, j); }
+            return j * (j - 1) / 2 + i;
+        }
+
+    public:
+        /// An empty matrix
+        CondensedMatrix() : n(0), wide(false) {}
+
+        /** A matrix with \a n rows, all of whose distances are 0, that can
+         *  store distances up to \a max_value.
+         */
+        CondensedMatrix(size_type n, size_type max_value);
+
+        /** A copy of a full matrix.
+         *  Only the cells above the diagonal are looked at.
+         */
+        explicit CondensedMatrix(const dist_type& full);
+
+        /// Returns the number of rows (and columns)
+        size_type size() const { return n; }
+
+        /// Returns whether the cells take 32 bits instead of 16
+        bool is_wide() const { return wide; }
+
+        /// Returns the distance between \a i and \a j
+        size_type get(size_type i, size_type j) const
+        {
+            if (i == j) { return 0; }
+            return wide ? wide_cells[index(i, j)] : narrow_cells[index(i, j)];
+        }
+
+        /// Sets the distance between \a i and \a j, which must differ
+        void set(size_type i, size_type j, size_type d)
+        {
+            if (wide) { wide_cells[index(i, j)] = static_cast<std::uint32_t>(d); }
+            else { narrow_cells[index(i, j)] = static_cast<std::uint16_t>(d); }
+        }
+
+        /** Changes the number of rows to \a new_n.
+         *  Distances between rows that are kept stay the same, and new ones
+         *  are 0.
+         */
+        void resize(size_type new_n);
+    };
+}
+
+#endif // CONDENSED_MATRIX_H
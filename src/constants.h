@@ -14,6 +14,7 @@
 #include "exception.h"
 
 #include <cmath>
+#include <cstdint>
 #include <list>
 #include <set>
 #include <utility>
@@ -111,6 +112,22 @@ namespace retrocombinator
             }
         }
         ///@}
+
+        ///@{
+        /** Nucleotides are packed into words, two bits per nucleotide, with the
+         *  bits holding the nucleotide index based on NUC_VALS.
+         *  Nucleotide \a i of a sequence lives in word <tt>i / NUC_PER_WORD</tt>,
+         *  at bit offset <tt>NUC_BITS * (i % NUC_PER_WORD)</tt>.
+         */
+        /// Number of bits used to store one nucleotide
+        const unsigned NUC_BITS = 2;
+        /// Number of nucleotides that fit in one packed word
+        const std::size_t NUC_PER_WORD = 32;
+        /// Mask for a single nucleotide within a packed word
+        const std::uint64_t NUC_MASK = 0x3;
+        /// Mask for the lower bit of every nucleotide within a packed word
+        const std::uint64_t NUC_LOW_BITS = 0x5555555555555555ULL;
+        ///@}
     }
 
     /// Type for transition matrices and rate matrices
@@ -126,6 +143,8 @@ namespace retrocombinator
     typedef std::size_t size_type;
     /// For all integer-based codes
     typedef long tag_type;
+    /// Type for a word of packed nucleotides, see Consts::NUC_PER_WORD
+    typedef std::uint64_t word_type;
 
     /// Type for a row in a distance matrix
     typedef std::vector<size_type> dist_row_type;
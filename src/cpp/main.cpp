@@ -21,8 +21,12 @@ int main() {
     double selection_threshold = 0.5;
     double family_coherence = 0.7;
     size_type max_num_representatives = 20;
+    size_type family_threads = Consts::FAMILY_THREADS_DEFAULT;
+    size_type family_update_cadence = Consts::FAMILY_UPDATE_CADENCE_DEFAULT;
+    double family_update_change = Consts::FAMILY_UPDATE_CHANGE_DEFAULT;
     size_t num_steps = 20;
     double time_per_step = 1;
+    bool track_distances = false;
     std::string filename_out {"simulationOutput.out"};
     size_type num_init_dist = 10;
     size_type num_pair_dist = 10;
@@ -44,7 +48,9 @@ int main() {
             recomb_mean, recomb_similarity,
             selection_threshold,
             family_coherence, max_num_representatives,
-            num_steps, time_per_step,
+            family_threads,
+            family_update_cadence, family_update_change,
+            num_steps, time_per_step, track_distances,
             filename_out,
             num_init_dist, num_pair_dist,
             num_fam_size, num_fam_dist,
@@ -0,0 +1,175 @@
+#include "distance_matrix.h"
+
+using namespace retrocombinator;
+
+namespace
+{
+    /// Matrices with fewer slots than this are never compacted
+    const size_type MIN_SLOTS_TO_COMPACT = 64;
+}
+
+size_type DistanceMatrix::new_slot(const Sequence& s)
+{
+    size_type slot;
+    if (!free_slots.empty())
+    {
+        slot = free_slots.back();
+        free_slots.pop_back();
+    }
+    else
+    {
+        slot = dist.size();
+        dist.resize(slot + 1);
+        members.push_back(nullptr);
+    }
+    slots[s.get_tag()] = slot;
+    members[slot] = &s;
+    return slot;
+}
+
+void DistanceMatrix::compact()
+{
+    std::vector<size_type> live;
+    for (size_type j=0; j<members.size(); ++j)
+    {
+        if (members[j]) { live.push_back(j); }
+    }
+
+    CondensedMatrix compacted(live.size(), sequence_length);
+    std::vector<const Sequence*> compacted_members(live.size());
+    for (size_type j=0; j<live.size(); ++j)
+    {
+        for (size_type i=0; i<j; ++i)
+        {
+            compacted.set(i, j, dist.get(live[i], live[j]));
+        }
+        compacted_members[j] = members[live[j]];
+        slots[compacted_members[j]->get_tag()] = j;
+    }
+    dist = std::move(compacted);
+    members.swap(compacted_members);
+    free_slots.clear();
+}
+
+size_type DistanceMatrix::slot_of(const Sequence& s) const
+{
+    auto found = slots.find(s.get_tag());
+    if (found == slots.end()) {
+        throw Exception("Sequence " + std::to_string(s.get_tag()) +
+                        " is not in the distance matrix");
+    }
+    return found->second;
+}
+
+bool DistanceMatrix::worth_comparing(const Sequence& s, size_type num_positions)
+{
+    // A comparison of whole sequences costs about one step per word
+    return num_positions > s.get_length() / Consts::NUC_PER_WORD;
+}
+
+void DistanceMatrix::add(const Sequence& s)
+{
+    compute_row(s, new_slot(s));
+}
+
+void DistanceMatrix::compute_row(const Sequence& s, size_type slot)
+{
+    for (size_type j=0; j<members.size(); ++j)
+    {
+        if (!members[j] || j == slot) { continue; }
+        dist.set(slot, j, s * *members[j]);
+    }
+}
+
+void DistanceMatrix::add_from(const Sequence& s, const Sequence& base)
+{
+    auto positions = s.differing_positions(base);
+    if (worth_comparing(s, positions.size()))
+    {
+        add(s);
+        return;
+    }
+
+    std::vector<char> ours, theirs;
+    for (auto n : positions)
+    {
+        ours.push_back(s.char_at(n));
+        theirs.push_back(base.char_at(n));
+    }
+
+    size_type base_slot = slot_of(base);
+    size_type slot = new_slot(s);
+    for (size_type j=0; j<members.size(); ++j)
+    {
+        if (!members[j] || j == slot) { continue; }
+        const Sequence& other = *members[j];
+
+        // The distance to other is that of base, corrected where s and base
+        // differ
+        long d = dist.get(base_slot, j);
+        for (size_type k=0; k<positions.size(); ++k)
+        {
+            char c = other.char_at(positions[k]);
+            d += long(ours[k] != c) - long(theirs[k] != c);
+        }
+        dist.set(slot, j, size_type(d));
+    }
+}
+
+void DistanceMatrix::update_mutated(const Sequence& s,
+                                    const Mutator::change_list& changes)
+{
+    if (changes.empty()) { return; }
+    if (worth_comparing(s, changes.size()))
+    {
+        compute_row(s, slot_of(s));
+        return;
+    }
+
+    std::vector<char> ours;
+    for (const auto& change : changes) { ours.push_back(s.char_at(change.first)); }
+
+    size_type slot = slot_of(s);
+    for (size_type j=0; j<members.size(); ++j)
+    {
+        if (!members[j] || j == slot) { continue; }
+        const Sequence& other = *members[j];
+
+        long d = dist.get(slot, j);
+        for (size_type k=0; k<changes.size(); ++k)
+        {
+            char c = other.char_at(changes[k].first);
+            d += long(ours[k] != c) - long(changes[k].second != c);
+        }
+        dist.set(slot, j, size_type(d));
+    }
+}
+
+void DistanceMatrix::remove(const Sequence& s)
+{
+    auto found = slots.find(s.get_tag());
+    if (found == slots.end()) { return; }
+    free_slots.push_back(found->second);
+    members[found->second] = nullptr;
+    slots.erase(found);
+    if (dist.size() >= MIN_SLOTS_TO_COMPACT && 2 * free_slots.size() > dist.size())
+    {
+        compact();
+    }
+}
+
+CondensedMatrix DistanceMatrix::as_matrix(const sequence_list& pool) const
+{
+    std::vector<size_type> order;
+    for (const auto& seq : pool) { order.push_back(slot_of(seq)); }
+
+    CondensedMatrix dist_mat(order.size(), sequence_length);
+    for (size_type j=0; j<order.size(); ++j)
+    {
+        for (size_type i=0; i<j; ++i)
+        {
+            dist_mat.set(i, j, dist.get(order[i], order[j]));
+        }
+    }
+    return dist_mat;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file
+ *
+ * \brief For the DistanceMatrix class, which keeps the pairwise distances
+ * between the sequences of a pool up to date as the pool changes
+ */
+#ifndef DISTANCE_MATRIX_H
+#define DISTANCE_MATRIX_H
+
+#include "condensed_matrix.h"
+#include "constants.h"
+#include "mutator.h"
+#include "sequence.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace retrocombinator
+{
+    /** The number of mismatches between every pair of sequences in a pool.
+     *
+     *  Rather than being recomputed whenever it is needed, the matrix is
+     *  updated with every change to the pool:
+     *  - a point mutation only changes the distances of its sequence, by
+     *    whether the new and old nucleotides match the other sequences
+     *  - a new sequence (a recombinant) differs from its first parent at a
+     *    few positions, so its distances follow from its parent's
+     *  - a sequence that is removed frees its slot, which is reused for the
+     *    next new sequence, and once most slots are free the matrix is
+     *    compacted
+     *
+     *  Sequences are identified by their tags, and each has a slot (a row and
+     *  column) in the matrix. Each slot also points to its sequence, so that
+     *  updating a row walks the slots directly rather than looking up the
+     *  slot of every sequence in the pool. Sequences must therefore stay
+     *  where they are while in the matrix (as they do in a sequence_list),
+     *  and be removed before they are destroyed.
+     */
+    class DistanceMatrix
+    {
+    private:
+        /// The length of the sequences, the largest possible distance
+        size_type sequence_length;
+
+        /// Distances between slots, unused slots hold junk
+        CondensedMatrix dist;
+
+        /// Which slot each sequence in the matrix has
+        std::unordered_map<tag_type, size_type> slots;
+
+        /// The sequence in each slot, null for free slots
+        std::vector<const Sequence*> members;
+
+        /// Slots of removed sequences, to be reused
+        std::vector<size_type> free_slots;
+
+        /// Returns a slot for \a s, growing the matrix if needed
+        size_type new_slot(const Sequence& s);
+
+        /// Moves the sequences into the lowest slots, and shrinks the matrix
+        void compact();
+
+        /// Returns the slot of sequence \a s, which must be in the matrix
+        size_type slot_of(const Sequence& s) const;
+
+        /** Fills in the distances of \a s (in \a slot) by comparing it to
+         *  every other sequence in the matrix.
+         */
+        void compute_row(const Sequence& s, size_type slot);
+
+        /** Whether correcting distances at \a num_positions positions of \a
+         *  s costs more than comparing the whole of \a s.
+         */
+        static bool worth_comparing(const Sequence& s, size_type num_positions);
+
+    public:
+        /// An empty matrix, for sequences of length \a sequence_length
+        explicit DistanceMatrix(size_type sequence_length) :
+            sequence_length(sequence_length), dist(0, sequence_length) {}
+
+        /// Returns whether \a s is in the matrix
+        bool contains(const Sequence& s) const
+        {
+            return slots.find(s.get_tag()) != slots.end();
+        }
+
+        /// Returns the number of sequences in the matrix
+        size_type size() const { return slots.size(); }
+
+        /// Adds \a s, by comparing it to every sequence in the matrix
+        void add(const Sequence& s);
+
+        /** Adds \a s, by finding where it differs from \a base (which is in
+         *  the matrix) and correcting the distances of \a base at those
+         *  positions.
+         *  Meant for sequences that are copies or recombinants of \a base.
+         */
+        void add_from(const Sequence& s, const Sequence& base);
+
+        /** Updates the distances of \a s, which has been mutated at
+         *  \a changes since the distances were last updated.
+         */
+        void update_mutated(const Sequence& s, const Mutator::change_list& changes);
+
+        /** Removes \a s, freeing its slot.
+         *  Compacts the matrix once more than half its slots are free.
+         */
+        void remove(const Sequence& s);
+
+        /** Returns the number of slots (rows) in the matrix, including free
+         *  ones.
+         */
+        size_type num_slots() const { return dist.size(); }
+
+        /// Returns the distance between two sequences in the matrix
+        size_type get(const Sequence& s1, const Sequence& s2) const
+        {
+            return dist.get(slot_of(s1), slot_of(s2));
+        }
+
+        /** Returns the distances between the sequences of \a pool, in the
+         *  order they are in the pool.
+         *  Every sequence of \a pool must be in the matrix.
+         */
+        CondensedMatrix as_matrix(const sequence_list& pool) const;
+    };
+}
+
+#endif // DISTANCE_MATRIX_H
@@ -2,43 +2,146 @@
 #include "utilities.h"
 #include "sequence.h"
 
+#include <algorithm>
+
 using namespace retrocombinator;
 
-Families::Families(size_type join_threshold_max, size_type max_num_representatives):
-    join_threshold_max(join_threshold_max), max_num_representatives(max_num_representatives)
+Families::Families(size_type join_threshold_max, size_type max_num_representatives,
+                   size_type num_threads):
+    join_threshold_max(join_threshold_max), num_threads(num_threads),
+    max_num_representatives(max_num_representatives),
+    update_cadence(Consts::FAMILY_UPDATE_CADENCE_DEFAULT),
+    update_change_fraction(Consts::FAMILY_UPDATE_CHANGE_DEFAULT),
+    last_update_timestep(0)
 {
+    Representative::renumber_representatives();
+}
+
+void Families::set_update_schedule(size_type cadence, double change_fraction) {
+    if (change_fraction < 0) {
+        throw Exception("The fraction of the pool that changes cannot be negative");
+    }
+    update_cadence = cadence;
+    update_change_fraction = change_fraction;
+}
+
+bool Families::update_due(const Pool& pool, size_type timestep) const {
+    if (last_update_timestep == 0) { return true; }
+    if (update_cadence > 0 &&
+        timestep - last_update_timestep >= update_cadence) { return true; }
+
+    size_type entered = 0, stayed = 0;
+    for (const auto& seq : pool.get_pool()) {
+        if (membership.count(seq.get_tag())) { ++stayed; }
+        else { ++entered; }
+    }
+    size_type changed = entered + (membership.size() - stayed);
+    return changed > update_change_fraction * std::max<size_type>(1, membership.size());
 }
 
 void Families::update(const Pool& pool, const size_type timestep) {
-    if (representatives.size() >= max_num_representatives) { return; }
+    size_type first_new_rep = representatives.size();
+    if (representatives.size() < max_num_representatives) {
+        add_representatives(pool, timestep);
+    }
+    update_membership(pool, first_new_rep);
+    last_update_timestep = timestep;
+}
 
-    auto dist_mat = pool.get_distance_matrix();
-    auto clusters = Utils::cluster_slink(dist_mat, pool.get_pool().size(),
-                                         join_threshold_max);
+void Families::add_representatives(const Pool& pool, const size_type timestep) {
+    // Families are the connected components of sequences that are closer
+    // than the threshold, which only needs the pairs checked up to there
+    std::vector<const Sequence*> sequences;
+    for (const auto& s : pool.get_pool()) { sequences.push_back(&s); }
+    const size_type threshold = join_threshold_max;
+    auto clusters = Utils::cluster_threshold(sequences.size(),
+        [&sequences, threshold](size_type i, size_type j) {
+            // within_distance is inclusive, so compare against one less
+            return threshold > 0 &&
+                   within_distance(*sequences[i], *sequences[j], threshold - 1);
+        }, num_threads);
     auto local_representatives = Utils::select_representatives(clusters);
 
     auto it = pool.get_pool().begin();
     for (size_type i=0,r=0; i < pool.get_pool().size(); ++i, ++it) {
+        if (r >= local_representatives.size()) { break; }
         if (i < local_representatives[r]) { continue; }
 
-        bool new_rep = true;
-        for (size_type k=0; k < representatives.size(); ++k) {
-            if (((*it) * representatives[k].raw_sequence) < join_threshold_max) {
-                new_rep = false;
-                break;
-            }
-        }
+        // within_distance is inclusive, so compare against one less
+        bool new_rep = join_threshold_max == 0 ||
+                       !has_representative_within(*it, join_threshold_max - 1);
         if (new_rep) {
+            size_type n = representatives.size();
+            if (n == 0) {
+                rep_pairwise_dist = CondensedMatrix(0, it->get_length());
+            }
             representatives.push_back(
-                Representative(it->as_string(), it->num_mutations(), timestep));
-            rep_pairwise_dist.emplace_back();
-            for (size_type i=0; i<representatives.size(); ++i) {
-                rep_pairwise_dist[i].emplace_back(
-                    representatives[i].raw_sequence * representatives.back().raw_sequence);
+                Representative(it->dense_bases(), it->num_mutations(), timestep));
+            const PackedBases& added = representatives.back().raw_sequence;
+            rep_pairwise_dist.resize(n + 1);
+            for (size_type k=0; k<n; ++k) {
+                rep_pairwise_dist.set(k, n,
+                    distance(representatives[k].raw_sequence, added));
             }
+            rep_index.insert(n, [this, n](size_type k, size_type) {
+                return rep_pairwise_dist.get(k, n);
+            });
         }
         if (representatives.size() >= max_num_representatives) { return; }
         ++r;
     }
 
 }
+
+void Families::update_membership(const Pool& pool, size_type first_new_rep) {
+    // Sequences that left the pool are dropped. New sequences (such as
+    // recombinants) and ones that point mutations have changed are looked up
+    // again, and the others are only compared with the new representatives.
+    std::unordered_map<tag_type, Membership> current;
+    current.reserve(pool.get_pool().size());
+    for (const auto& seq : pool.get_pool()) {
+        Membership& seq_membership = current[seq.get_tag()];
+        seq_membership.num_changes = seq.get_num_changes();
+        if (join_threshold_max == 0) { continue; }
+
+        // within_distance is inclusive, so compare against one less
+        auto previous = membership.find(seq.get_tag());
+        if (previous != membership.end() &&
+            previous->second.num_changes == seq.get_num_changes()) {
+            seq_membership.families.swap(previous->second.families);
+            for (size_type k = first_new_rep; k < representatives.size(); ++k) {
+                if (within_distance(seq, representatives[k].raw_sequence,
+                                    join_threshold_max - 1)) {
+                    seq_membership.families.push_back(k);
+                }
+            }
+        }
+        else {
+            seq_membership.families =
+                representatives_within(seq, join_threshold_max - 1);
+        }
+    }
+    membership.swap(current);
+}
+
+const std::vector<size_type>& Families::families_of(tag_type tag) const {
+    static const std::vector<size_type> none;
+    auto it = membership.find(tag);
+    return it == membership.end() ? none : it->second.families;
+}
+
+bool Families::has_representative_within(const Sequence& sequence,
+                                         size_type max_d) const
+{
+    return rep_index.any_within(max_d, [this, &sequence](size_type k, size_type bound) {
+        return bounded_distance(sequence, representatives[k].raw_sequence, bound);
+    });
+}
+
+std::vector<size_type> Families::representatives_within(const Sequence& sequence,
+                                                        size_type max_d) const
+{
+    return rep_index.all_within(max_d, [this, &sequence](size_type k, size_type bound) {
+        return bounded_distance(sequence, representatives[k].raw_sequence, bound);
+    });
+}
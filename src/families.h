@@ -7,11 +7,36 @@
 #ifndef FAMILIES_H
 #define FAMILIES_H
 
+#include "bk_tree.h"
+#include "condensed_matrix.h"
 #include "pool.h"
 #include "representative.h"
 
+#include <unordered_map>
+
 namespace retrocombinator
 {
+    namespace Consts {
+
+        /** By default, new families are looked for on at most this many
+         *  threads. Kept low, as the simulation usually runs inside R, where
+         *  packages should not use more than two cores unless asked to.
+         */
+        const size_type FAMILY_THREADS_DEFAULT = 2;
+
+        /** By default, families are only updated on the steps they are
+         *  output, and not on a fixed cadence (see Families::set_update_schedule).
+         */
+        const size_type FAMILY_UPDATE_CADENCE_DEFAULT = 0;
+
+        /** By default, families are also updated once this fraction of the
+         *  pool has been replaced since the last update, so that families that
+         *  emerge between outputs are still found while they last.
+         */
+        const double FAMILY_UPDATE_CHANGE_DEFAULT = 0.25;
+
+    }
+
     /** To store all families of retrotranposons that emerge during a
       * simulation, by saving a representative for each family.
       */
@@ -24,6 +49,11 @@ namespace retrocombinator
           */
         const size_type join_threshold_max;
 
+        /** How many threads to look for new families on (0 for as many as
+         *  the hardware supports)
+         */
+        const size_type num_threads;
+
         /** The maximum number of families to keep track of (we stop keeping
          *  track of families that emerge once this threshold is passed)
           */
@@ -32,8 +62,55 @@ namespace retrocombinator
         /// What the actual representatives for each family are
         std::vector<Representative> representatives;
 
-        /// dist[i][j] stores the distance between rep_i and rep_j for i <= j
-        dist_type rep_pairwise_dist;
+        /// An index over the representatives, by distance between them
+        BKTree rep_index;
+
+        /** The distance between every two representatives, grown by a row
+         *  and column when a new representative is added
+         */
+        CondensedMatrix rep_pairwise_dist;
+
+        /// The families a sequence belongs to
+        struct Membership
+        {
+            /** Sequence::get_num_changes() of the sequence when its families
+             *  were looked up
+             */
+            size_type num_changes;
+            /// Indices into \p representatives, in increasing order
+            std::vector<size_type> families;
+        };
+
+        /** The families that each sequence in the pool belonged to at the
+         *  last update, by sequence tag.
+         */
+        std::unordered_map<tag_type, Membership> membership;
+
+        /** Saves a representative for every cluster in \p pool that is not
+         *  close to an existing representative, until there are \p
+         *  max_num_representatives.
+         */
+        void add_representatives(const Pool& pool, size_type timestep);
+
+        /** Records which families every sequence in \p pool belongs to.
+         *  Sequences that have not changed since the last update are only
+         *  compared against the representatives from \a first_new_rep on.
+         */
+        void update_membership(const Pool& pool, size_type first_new_rep);
+
+        /** Update every this many timesteps, regardless of anything else (0
+         *  for never)
+         */
+        size_type update_cadence;
+
+        /** Update once the fraction of sequences that entered or left the
+         *  pool since the last update passes this (0 for as soon as any
+         *  sequence enters or leaves)
+         */
+        double update_change_fraction;
+
+        /// When the families were last updated (0 if never)
+        size_type last_update_timestep;
     public:
         /**
           * \p join_threshold_max indicates that the distance between two
@@ -42,25 +119,72 @@ namespace retrocombinator
           *
           * Also, new representatives are saved only if they are more than
           * \p join_threshold_max away from previous representatives.
+          *
+          * New families are looked for on \p num_threads threads (0 for as
+          * many as the hardware supports), which does not change what is
+          * found.
+          */
+        Families(size_type join_threshold_max, size_type max_num_representatives,
+                 size_type num_threads);
+
+        /** Sets when update_due() asks for an update: every \a cadence
+          * timesteps (0 for never), and whenever more than \a change_fraction
+          * of the pool has been replaced since the last update.
+          * Updating every timestep (cadence 1) finds the most families.
+          */
+        void set_update_schedule(size_type cadence, double change_fraction);
+
+        /** Should the families be updated at \a timestep, given the current
+          * \a pool?
+          * Families are only discovered when they are updated, so a family
+          * is found if it exists at some update, and its representative is
+          * tagged with the timestep of that update. Membership is as of the
+          * last update. Callers that need it to be current (such as Output)
+          * should update on their steps as well.
           */
-        Families(size_type join_threshold_max, size_type max_num_representatives);
+        bool update_due(const Pool& pool, size_type timestep) const;
 
         /// Returns the maximum permitted distance between two clusters
-        double get_join_threshold_max() const { return join_threshold_max; }
+        size_type get_join_threshold_max() const { return join_threshold_max; }
 
         /// What are the representatives of each family?
         const std::vector<Representative>& get_representatives() const {
             return representatives;
         }
 
+        /** Is there a representative at most \a max_d away from \a sequence?
+          * Looks this up in an index, rather than comparing against every
+          * representative.
+          */
+        bool has_representative_within(const Sequence& sequence,
+                                       size_type max_d) const;
+
+        /** Which representatives are at most \a max_d away from \a sequence?
+          * \return indices into get_representatives(), in increasing order
+          */
+        std::vector<size_type> representatives_within(const Sequence& sequence,
+                                                      size_type max_d) const;
+
         /** What is the pairwise distance between the representatives of each
           * family?
           */
-        const dist_type& get_representative_matrix() const {
+        const CondensedMatrix& get_representative_matrix() const {
             return rep_pairwise_dist;
         }
+        /** Which families did the sequence with tag \a tag belong to at the
+          * last update?
+          * A sequence belongs to every family whose representative is closer
+          * than \p join_threshold_max to it.
+          * \return indices into get_representatives(), in increasing order,
+          * and none for sequences that were not in the pool then
+          */
+        const std::vector<size_type>& families_of(tag_type tag) const;
+
         /** Store new representatives if need, and re-calculate the pairwise
-          * distance matrix between representatives if needed
+          * distance matrix between representatives if needed.
+          * Also records which families each sequence in the pool belongs to,
+          * looking up only the sequences that are new or have changed since
+          * the last update.
           */
         void update(const Pool& pool, size_type timestep);
 
@@ -0,0 +1,203 @@
+#include "hamming.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define RETROCOMBINATOR_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+using namespace retrocombinator;
+
+namespace
+{
+    /** Folds every pair of bits of \a x (a XOR of two packed words) onto its
+     *  lower bit, so that there is one set bit per mismatching nucleotide.
+     */
+    inline word_type fold(word_type x)
+    {
+        return (x | (x >> 1)) & Consts::NUC_LOW_BITS;
+    }
+
+    /// Portable kernel, counts set bits of folded words with bit twiddling
+    size_type hamming_scalar(const word_type* a, const word_type* b, size_type n)
+    {
+        size_type differences = 0;
+        for (size_type i=0; i<n; ++i)
+        {
+            // a folded word already holds 0/1 counts in every pair of bits
+            word_type x = fold(a[i] ^ b[i]);
+            x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+            x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+            differences += (x * 0x0101010101010101ULL) >> 56;
+        }
+        return differences;
+    }
+
+#ifdef RETROCOMBINATOR_X86_KERNELS
+    /// Uses the hardware POPCNT instruction (SSE4.2 era CPUs)
+    __attribute__((target("popcnt")))
+    size_type hamming_popcnt(const word_type* a, const word_type* b, size_type n)
+    {
+        size_type differences = 0;
+        for (size_type i=0; i<n; ++i)
+        {
+            differences += __builtin_popcountll(fold(a[i] ^ b[i]));
+        }
+        return differences;
+    }
+
+    /** Counts 4 words at a time, with the nibble lookup table popcount
+     *  (Mula et al. 2018) and sums of absolute differences to accumulate.
+     */
+    __attribute__((target("avx2,popcnt")))
+    size_type hamming_avx2(const word_type* a, const word_type* b, size_type n)
+    {
+        const __m256i low_bits = _mm256_set1_epi64x(Consts::NUC_LOW_BITS);
+        const __m256i nibble = _mm256_set1_epi8(0x0F);
+        const __m256i lookup = _mm256_setr_epi8(
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i zero = _mm256_setzero_si256();
+
+        __m256i total = zero;
+        size_type i = 0;
+        for (; i+4 <= n; i += 4)
+        {
+            __m256i x = _mm256_xor_si256(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+            x = _mm256_and_si256(_mm256_or_si256(x, _mm256_srli_epi64(x, 1)),
+                                 low_bits);
+            __m256i lo = _mm256_and_si256(x, nibble);
+            __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble);
+            __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                             _mm256_shuffle_epi8(lookup, hi));
+            total = _mm256_add_epi64(total, _mm256_sad_epu8(counts, zero));
+        }
+
+        size_type differences =
+            _mm256_extract_epi64(total, 0) + _mm256_extract_epi64(total, 1) +
+            _mm256_extract_epi64(total, 2) + _mm256_extract_epi64(total, 3);
+        for (; i<n; ++i)
+        {
+            differences += __builtin_popcountll(fold(a[i] ^ b[i]));
+        }
+        return differences;
+    }
+
+    /// Folded popcount of 8 words of XOR-ed nucleotides, for AVX-512
+    __attribute__((target("avx512f,avx512vpopcntdq")))
+    inline __m512i count_avx512(__m512i x)
+    {
+        // the masked shift avoids the unmasked form's undefined-value operand
+        const __mmask8 all = 0xFF;
+        x = _mm512_or_si512(x, _mm512_maskz_srli_epi64(all, x, 1));
+        x = _mm512_and_si512(x, _mm512_set1_epi64(Consts::NUC_LOW_BITS));
+        return _mm512_popcnt_epi64(x);
+    }
+
+    /** Counts 8 words at a time with the AVX-512 VPOPCNTQ instruction, the
+     *  tail is handled with a masked load.
+     */
+    __attribute__((target("avx512f,avx512vpopcntdq")))
+    size_type hamming_avx512(const word_type* a, const word_type* b, size_type n)
+    {
+        __m512i total = _mm512_set1_epi64(0);
+        size_type i = 0;
+        for (; i+8 <= n; i += 8)
+        {
+            total = _mm512_add_epi64(total, count_avx512(_mm512_xor_si512(
+                _mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i))));
+        }
+        if (i < n)
+        {
+            __mmask8 tail = static_cast<__mmask8>((1u << (n - i)) - 1);
+            total = _mm512_add_epi64(total, count_avx512(_mm512_xor_si512(
+                _mm512_maskz_loadu_epi64(tail, a + i),
+                _mm512_maskz_loadu_epi64(tail, b + i))));
+        }
+
+        word_type lanes[8];
+        _mm512_storeu_si512(lanes, total);
+        size_type differences = 0;
+        for (size_type k=0; k<8; ++k)
+        {
+            differences += lanes[k];
+        }
+        return differences;
+    }
+#endif // RETROCOMBINATOR_X86_KERNELS
+}
+
+std::vector<word_type> Hamming::pack(const std::string& s)
+{
+    std::vector<word_type> words(
+        (s.size() + Consts::NUC_PER_WORD - 1) / Consts::NUC_PER_WORD, 0);
+    for (size_type i=0; i<s.size(); ++i)
+    {
+        words[i / Consts::NUC_PER_WORD] |=
+            word_type(Consts::NUC_CHAR2INT(s[i])) <<
+            (Consts::NUC_BITS * (i % Consts::NUC_PER_WORD));
+    }
+    return words;
+}
+
+const std::vector<Hamming::kernel_info>& Hamming::available_kernels()
+{
+    static const std::vector<kernel_info> kernels = []()
+    {
+        std::vector<kernel_info> found { kernel_info { "scalar", hamming_scalar } };
+#ifdef RETROCOMBINATOR_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("popcnt"))
+        {
+            found.push_back(kernel_info { "popcnt", hamming_popcnt });
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+        {
+            found.push_back(kernel_info { "avx2", hamming_avx2 });
+        }
+        if (__builtin_cpu_supports("avx512f") &&
+            __builtin_cpu_supports("avx512vpopcntdq"))
+        {
+            found.push_back(kernel_info { "avx512", hamming_avx512 });
+        }
+#endif
+        return found;
+    }();
+    return kernels;
+}
+
+Hamming::kernel_info& Hamming::active()
+{
+    // the fastest kernel is the last one available
+    static kernel_info kernel = available_kernels().back();
+    return kernel;
+}
+
+std::string Hamming::get_kernel_name()
+{
+    return active().name;
+}
+
+std::vector<std::string> Hamming::get_available_kernels()
+{
+    std::vector<std::string> names;
+    for (const auto& info : available_kernels())
+    {
+        names.push_back(info.name);
+    }
+    return names;
+}
+
+void Hamming::set_kernel(std::string name)
+{
+    for (const auto& info : available_kernels())
+    {
+        if (name == info.name)
+        {
+            active() = info;
+            return;
+        }
+    }
+    throw Exception("Hamming kernel " + name + " is not available");
+}
@@ -0,0 +1,79 @@
+/**
+ * @file
+ *
+ * \brief Kernels that count mismatching nucleotides between packed sequences
+ */
+#ifndef HAMMING_H
+#define HAMMING_H
+
+#include "constants.h"
+
+#include <string>
+#include <vector>
+
+namespace retrocombinator
+{
+    /** Counts the number of nucleotides that differ between two runs of packed
+     *  words (see Consts::NUC_PER_WORD).
+     *
+     *  Each word is XOR-ed, the two bits of every nucleotide are folded onto
+     *  one, and the folded bits are counted. There are several implementations
+     *  of this (portable, POPCNT, AVX2 and AVX-512), the fastest one that the
+     *  CPU supports is picked the first time a distance is asked for.
+     *  Stored in a class to prevent namespace conflicts.
+     */
+    class Hamming
+    {
+    public:
+        /// Type for a function that counts mismatches in \a n words
+        typedef size_type (*kernel_type)(const word_type* a, const word_type* b,
+                                         size_type n);
+
+        /** Number of nucleotides that differ between the first \a n words of
+         *  \a a and \a b.
+         */
+        static size_type distance(const word_type* a, const word_type* b,
+                                  size_type n)
+        {
+            return active_kernel()(a, b, n);
+        }
+
+        /** Packs a string of nucleotides into words.
+         *  Bits beyond the length of the string in the last word are 0.
+         */
+        static std::vector<word_type> pack(const std::string& s);
+
+        /// Name of the kernel that is currently in use
+        static std::string get_kernel_name();
+
+        /** Names of all kernels that can run on this CPU, from slowest to
+         *  fastest.
+         */
+        static std::vector<std::string> get_available_kernels();
+
+        /** Use a specific kernel instead of the one picked by CPU detection.
+         *  Throws an exception if the kernel cannot run on this CPU.
+         *  Used for testing the kernels against each other.
+         */
+        static void set_kernel(std::string name);
+
+    private:
+        /// A kernel along with its name
+        struct kernel_info
+        {
+            const char * name;
+            kernel_type kernel;
+        };
+
+        /// All kernels that can run on this CPU, from slowest to fastest
+        static const std::vector<kernel_info>& available_kernels();
+
+        /// The kernel in use, chosen the first time it is needed
+        static kernel_info& active();
+
+        /// Shortcut for the function of the kernel in use
+        static kernel_type active_kernel() { return active().kernel; }
+    };
+}
+
+#endif // HAMMING_H
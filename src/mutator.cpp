@@ -1,6 +1,5 @@
 #include "point_mutation_models.h"
 #include "mutator.h"
-#include "rand_maths.h"
 #include "sequence.h"
 
 using namespace retrocombinator;
@@ -42,16 +41,42 @@ Mutator::~Mutator()
     delete point_mutation_model;
 }
 
-void Mutator::mutate_sequence(Sequence& s, double time_per_step) const
+void Mutator::mutate_sequence(Sequence& s, double time_per_step,
+                              RandMaths& rng, change_list* changes) const
 {
-    auto tr_mat = point_mutation_model->get_transition_matrix(time_per_step);
+    // Make sure the model's tables are for this time step
+    point_mutation_model->get_transition_matrix(time_per_step);
+    double p_max = point_mutation_model->get_max_change_probability();
+    if (p_max <= 0)
+    {
+        return;
+    }
+
+    // Gaps between candidate sites and the uniforms that pick their new
+    // nucleotides are drawn in batches
+    const size_type BATCH = 32;
+    size_type gaps[BATCH];
+    double uniforms[BATCH];
 
     size_type n = s.get_length();
-    for (size_type i=0; i<n; ++i)
+    size_type next_site = 0;
+    while (true)
     {
-        int mutation_index = RNG.choose_event(tr_mat[Consts::NUC_CHAR2INT(s.char_at(i))],
-                                              Consts::NUC_COUNT);
-        s.point_mutate(i, Consts::NUC_INT2CHAR(mutation_index));
+        rng.fill_geometric(gaps, BATCH, p_max);
+        rng.fill_uniform(uniforms, BATCH);
+        for (size_type k = 0; k < BATCH; ++k)
+        {
+            if (gaps[k] >= n - next_site) { return; }
+            size_type i = next_site + gaps[k];
+
+            int from = Consts::NUC_CHAR2INT(s.char_at(i));
+            int to = point_mutation_model->sample_candidate(from, uniforms[k]);
+            if (to != from)
+            {
+                if (changes) { changes->emplace_back(i, Consts::NUC_INT2CHAR(from)); }
+                s.point_mutate(i, Consts::NUC_INT2CHAR(to), rng);
+            }
+            next_site = i + 1;
+        }
     }
 }
-
@@ -19,22 +19,43 @@ namespace retrocombinator
      */
     class Mutator
     {
+    public:
+        /** Positions that were mutated, in ascending order, each with the
+         *  nucleotide it had before.
+         *  A position is mutated at most once in a step.
+         */
+        typedef std::vector<std::pair<size_type, char> > change_list;
+
     private:
         /// Which point mutation model this mutator corresponds to
         PointMutationModel * point_mutation_model;
 
     public:
         /** Chooses a point mutation model.
-         *  Can be "JC69", "K80", "F81", "HKY85", "TN93" or "GTR", but note that
-         *  "GTR" is not yet implemented
+         *  Can be "JC69", "K80", "F81", "HKY85", "TN93" or "GTR"
          */
         Mutator(std::string model);
 
         /// Destructor that frees up memory
         ~Mutator();
 
-        /// Mutates a sequence according to a given transition matrix
-        void mutate_sequence(Sequence& s, double time_per_step) const;
+        /** Mutates a sequence according to a given transition matrix.
+         *
+         *  Every site changes independently, with a probability that depends
+         *  on its nucleotide. Rather than testing every site, the gaps between
+         *  candidate sites are drawn from a geometric distribution with the
+         *  largest of these probabilities. Each candidate is then kept with
+         *  the probability for its nucleotide divided by the largest one, and
+         *  given a new nucleotide, with one draw from the model's alias tables
+         *  (see PointMutationModel::sample_candidate()). This is equivalent
+         *  to testing every site, but does work in proportion to the number of
+         *  mutations.
+         *
+         *  Random numbers are drawn from \a rng. If \a changes is given, the
+         *  positions that were changed are appended to it (see change_list).
+         */
+        void mutate_sequence(Sequence& s, double time_per_step,
+                             RandMaths& rng, change_list* changes = nullptr) const;
     };
 }
 
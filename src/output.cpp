@@ -25,14 +25,10 @@ Output::~Output() {
 }
 
 void Output::output(size_type t, const Pool& pool, const Families& families) {
-    bool p_init_dist = (t % to_print_init_dist == 0 ||
-            (t == final_timestep && to_print_init_dist <= final_timestep));
-    bool p_pair_dist = (t % to_print_pair_dist == 0 ||
-            (t == final_timestep && to_print_pair_dist <= final_timestep));
-    bool p_fam_size = (t % to_print_fam_size == 0 ||
-            (t == final_timestep && to_print_fam_size <= final_timestep));
-    bool p_fam_dist = (t % to_print_fam_dist == 0 ||
-            (t == final_timestep && to_print_fam_dist <= final_timestep));
+    bool p_init_dist = is_print_step(t, to_print_init_dist);
+    bool p_pair_dist = is_print_step(t, to_print_pair_dist);
+    bool p_fam_size = is_print_step(t, to_print_fam_size);
+    bool p_fam_dist = is_print_step(t, to_print_fam_dist);
 
     if (p_init_dist) { print_initial_dist(t, pool); }
     if (p_pair_dist) { print_pairwise_dist(t, pool); }
@@ -40,6 +36,10 @@ void Output::output(size_type t, const Pool& pool, const Families& families) {
     if (p_fam_dist) { print_family_dist(t, families); }
 }
 
+bool Output::prints_families(size_type t) const {
+    return is_print_step(t, to_print_fam_size) || is_print_step(t, to_print_fam_dist);
+}
+
 void Output::print_initial_dist(size_type t, const Pool& pool)
 {
     fout << "Init<" << std::endl;
@@ -68,7 +68,8 @@ void Output::print_pairwise_dist(size_type t, const Pool& pool)
     size_type d;
     for (auto it = pool.get_pool().begin(); it != pool.get_pool().end(); ++it) {
         for (auto jt = std::next(it); jt != pool.get_pool().end(); ++jt) {
-            d = (*it) * (*jt);
+            d = pool.tracks_distances() ? pool.get_distances().get(*it, *jt) :
+                bounded_distance(*it, *jt, max_seq_dist_incl);
             if(d <= max_seq_dist_incl) {
                 fout << it->get_tag() << ":" << jt->get_tag() << ":" << d << std::endl;
             }
@@ -85,12 +86,19 @@ void Output::print_family_sizes(size_type t, const Families& families, const Poo
     fout << "!" << families.get_representatives().size() << std::endl;
     fout << "!" << pool.get_pool().size() << std::endl;
 
-    for (auto rep : families.get_representatives()) {
-        fout << rep.tag << ":" << rep.creation_timestep << ":";
-        for (const auto& seq : pool.get_pool()) {
-            if(seq % rep.raw_sequence < families.get_join_threshold_max()) {
-                fout << seq.get_tag() << ",";
-            }
+    // membership was recorded when the families were last updated
+    const auto& reps = families.get_representatives();
+    std::vector<std::vector<tag_type>> members(reps.size());
+    for (const auto& seq : pool.get_pool()) {
+        for (auto k : families.families_of(seq.get_tag())) {
+            members[k].push_back(seq.get_tag());
+        }
+    }
+
+    for (size_type k = 0; k < reps.size(); ++k) {
+        fout << reps[k].tag << ":" << reps[k].creation_timestep << ":";
+        for (auto tag : members[k]) {
+            fout << tag << ",";
         }
         fout << std::endl;
     }
@@ -107,8 +115,8 @@ void Output::print_family_dist(size_type t, const Families& families)
     const auto& matrix = families.get_representative_matrix();
     for (size_type i = 0; i < reps.size(); ++i) {
         for (size_type j = i+1; j < reps.size(); ++j) {
-            if(matrix[i][j] <= max_seq_dist_incl) {
-                fout << reps[i].tag << ":" << reps[j].tag << ":" << matrix[i][j] << std::endl;
+            if(matrix.get(i, j) <= max_seq_dist_incl) {
+                fout << reps[i].tag << ":" << reps[j].tag << ":" << matrix.get(i, j) << std::endl;
             }
         }
     }
@@ -124,7 +132,9 @@ void Output::print_params(
     double recomb_mean, double recomb_similarity,
     double selection_threshold,
     double family_coherence, size_type max_num_representatives,
-    size_type num_steps, double time_per_step,
+    size_type family_threads,
+    size_type family_update_cadence, double family_update_change,
+    size_type num_steps, double time_per_step, bool track_distances,
     std::string filename_out,
     size_type num_init_dist, size_type num_pair_dist,
     size_type num_fam_size, size_type num_fam_dist,
@@ -162,10 +172,14 @@ void Output::print_params(
     header = "FamilyParams";
     fout << header + "_" + "familyCoherence:" << family_coherence  << std::endl;
     fout << header + "_" + "maxFamilyRepresentatives:" << max_num_representatives  << std::endl;
+    fout << header + "_" + "numThreads:" << family_threads  << std::endl;
+    fout << header + "_" + "updateCadence:" << family_update_cadence  << std::endl;
+    fout << header + "_" + "updateChangeFraction:" << family_update_change  << std::endl;
 
     header = "SimulationParams";
     fout << header + "_" + "numSteps:" << num_steps  << std::endl;
     fout << header + "_" + "timePerStep:" << time_per_step  << std::endl;
+    fout << header + "_" + "trackDistances:" << (track_distances ? "TRUE" : "FALSE") << std::endl;
 
     header = "OutputParams";
     fout << header + "_" + "outputFileName:" << filename_out  << std::endl;
@@ -44,6 +44,11 @@ namespace retrocombinator
           */
         void output(size_type t, const Pool& pool, const Families& families);
 
+        /** Does output() print anything about families at timestep \p t?
+          * If so, the families need to be up to date then.
+          */
+        bool prints_families(size_type t) const;
+
         ///@{
         /// Prints the simulation parameters to file
         void print_params(
@@ -54,7 +59,9 @@ namespace retrocombinator
             double recomb_mean, double recomb_similarity,
             double selection_threshold,
             double family_coherence, size_type max_num_representatives,
-            size_type num_steps, double time_per_step,
+            size_type family_threads,
+            size_type family_update_cadence, double family_update_change,
+            size_type num_steps, double time_per_step, bool track_distances,
             std::string filename_out,
             size_type num_init_dist, size_type num_pair_dist,
             size_type num_fam_size, size_type num_fam_dist,
@@ -77,6 +84,15 @@ namespace retrocombinator
         const size_type to_print_fam_dist;
         ///@}
 
+        /** Is \p t a timestep to print on, for something that is printed
+          * every \p to_print timesteps (and at the end)?
+          */
+        bool is_print_step(size_type t, size_type to_print) const
+        {
+            return t % to_print == 0 ||
+                   (t == final_timestep && to_print <= final_timestep);
+        }
+
         /** What is the largest sequence distance we
           * should print out (inclusive)? Distances greater than this are
           * suppressed (not printed) in the output file
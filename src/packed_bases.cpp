@@ -0,0 +1,161 @@
+#include "packed_bases.h"
+#include "hamming.h"
+
+#include <algorithm>
+
+namespace retrocombinator
+{
+    const size_type PackedBases::CHUNK_WORDS;
+    const size_type PackedBases::CHUNK_NUCS;
+
+    size_type distance(const PackedBases& a, const PackedBases& b)
+    {
+        if (a.get_length() != b.get_length()) {
+            throw Exception("Cannot compare sequences of different lengths.");
+        }
+        size_type differences = 0;
+        for (size_type c=0; c<a.num_chunks(); ++c)
+        {
+            if (a.shares_chunk(b, c)) { continue; }
+            differences += Hamming::distance(a.chunk_words(c), b.chunk_words(c),
+                                             PackedBases::CHUNK_WORDS);
+        }
+        return differences;
+    }
+
+    size_type bounded_distance(const PackedBases& a, const PackedBases& b,
+                               size_type max_d)
+    {
+        if (a.get_length() != b.get_length()) {
+            throw Exception("Cannot compare sequences of different lengths.");
+        }
+        size_type differences = 0;
+        for (size_type c=0; c<a.num_chunks() && differences<=max_d; ++c)
+        {
+            if (a.shares_chunk(b, c)) { continue; }
+            differences += Hamming::distance(a.chunk_words(c), b.chunk_words(c),
+                                             PackedBases::CHUNK_WORDS);
+        }
+        return differences;
+    }
+}
+
+using namespace retrocombinator;
+
+PackedBases::PackedBases(size_type length) :
+    length(length)
+{
+    for (size_type c=0; c<num_chunks_for(length); ++c)
+    {
+        chunks.push_back(std::make_shared<Chunk>());
+        std::fill(chunks.back()->words, chunks.back()->words + CHUNK_WORDS, 0);
+    }
+}
+
+PackedBases::PackedBases(const std::string& s) :
+    PackedBases(s.size(), Hamming::pack(s))
+{}
+
+PackedBases::PackedBases(size_type length, const std::vector<word_type>& words) :
+    PackedBases(length)
+{
+    size_type num_words = (length + Consts::NUC_PER_WORD - 1) / Consts::NUC_PER_WORD;
+    if (words.size() < num_words) {
+        throw Exception("Not enough words for the nucleotides");
+    }
+    for (size_type w=0; w<num_words; ++w)
+    {
+        chunks[w / CHUNK_WORDS]->words[w % CHUNK_WORDS] = words[w];
+    }
+    // keep the bits beyond the end of the sequence 0
+    size_type tail = length % Consts::NUC_PER_WORD;
+    if (tail != 0)
+    {
+        chunks[(num_words-1) / CHUNK_WORDS]->words[(num_words-1) % CHUNK_WORDS] &=
+            (word_type(1) << (Consts::NUC_BITS * tail)) - 1;
+    }
+}
+
+PackedBases::Chunk& PackedBases::writable_chunk(size_type c)
+{
+    if (chunks[c].use_count() > 1)
+    {
+        chunks[c] = std::make_shared<Chunk>(*chunks[c]);
+    }
+    return *chunks[c];
+}
+
+void PackedBases::set_base(size_type n, int base)
+{
+    unsigned shift = Consts::NUC_BITS * (n % Consts::NUC_PER_WORD);
+    word_type& word =
+        writable_chunk(n / CHUNK_NUCS).words[(n % CHUNK_NUCS) / Consts::NUC_PER_WORD];
+    word = (word & ~(Consts::NUC_MASK << shift)) | (word_type(base) << shift);
+}
+
+void PackedBases::splice(const PackedBases& other, size_type beg, size_type end)
+{
+    if (other.length != length) {
+        throw Exception("Cannot splice sequences of different lengths.");
+    }
+    for (size_type c = beg / CHUNK_NUCS; beg < end; ++c)
+    {
+        size_type chunk_beg = c * CHUNK_NUCS;
+        size_type chunk_end = std::min(chunk_beg + CHUNK_NUCS, length);
+        size_type part_end = std::min(end, chunk_end);
+
+        if (chunks[c] == other.chunks[c])
+        {
+            // nothing to do
+        }
+        else if (beg == chunk_beg && part_end == chunk_end)
+        {
+            chunks[c] = other.chunks[c];
+        }
+        else
+        {
+            // [beg_word, end_word] are the words of this chunk touched
+            size_type beg_word = (beg - chunk_beg) / Consts::NUC_PER_WORD;
+            size_type end_word = (part_end - 1 - chunk_beg) / Consts::NUC_PER_WORD;
+            unsigned beg_shift = Consts::NUC_BITS * (beg % Consts::NUC_PER_WORD);
+            unsigned end_shift =
+                Consts::NUC_BITS * ((part_end - 1) % Consts::NUC_PER_WORD + 1);
+
+            // bits of the first and last word that fall inside the range
+            word_type beg_mask = ~word_type(0) << beg_shift;
+            word_type end_mask = end_shift == 64 ? ~word_type(0) :
+                                                   ((word_type(1) << end_shift) - 1);
+
+            word_type* ours = writable_chunk(c).words;
+            const word_type* theirs = other.chunks[c]->words;
+            if (beg_word == end_word)
+            {
+                word_type mask = beg_mask & end_mask;
+                ours[beg_word] = (ours[beg_word] & ~mask) | (theirs[beg_word] & mask);
+            }
+            else
+            {
+                ours[beg_word] = (ours[beg_word] & ~beg_mask) | (theirs[beg_word] & beg_mask);
+                std::copy(theirs + beg_word + 1, theirs + end_word, ours + beg_word + 1);
+                ours[end_word] = (ours[end_word] & ~end_mask) | (theirs[end_word] & end_mask);
+            }
+        }
+        beg = part_end;
+    }
+}
+
+std::string PackedBases::as_string() const
+{
+    std::string s(length, ' ');
+
+    for (size_type i=0; i<length; )
+    {
+        word_type word = chunks[i / CHUNK_NUCS]->words[(i % CHUNK_NUCS) / Consts::NUC_PER_WORD];
+        for (size_type k=0; k<Consts::NUC_PER_WORD && i<length; ++k, ++i)
+        {
+            s[i] = Consts::NUC_INT2CHAR(word & Consts::NUC_MASK);
+            word >>= Consts::NUC_BITS;
+        }
+    }
+    return s;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file
+ *
+ * \brief For the PackedBases class, the storage for the nucleotides of a
+ * sequence
+ */
+#ifndef PACKED_BASES_H
+#define PACKED_BASES_H
+
+#include "constants.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace retrocombinator
+{
+    /** The nucleotides of a sequence, packed Consts::NUC_PER_WORD to a word.
+     *
+     *  The words are grouped into fixed-size chunks that are reference counted
+     *  and shared between copies until one of the copies writes to them
+     *  (copy-on-write). Copying a PackedBases is therefore cheap, and
+     *  sequences that descend from each other share every chunk that neither
+     *  has mutated. Shared chunks are also skipped when computing distances.
+     */
+    class PackedBases
+    {
+    public:
+        /// Number of words in one chunk
+        static const size_type CHUNK_WORDS = 32;
+        /// Number of nucleotides in one chunk
+        static const size_type CHUNK_NUCS = CHUNK_WORDS * Consts::NUC_PER_WORD;
+
+        /** A block of words.
+         *  The bits beyond the length of the sequence in the last chunk are
+         *  always 0, so that whole chunks can be compared.
+         */
+        struct Chunk
+        {
+            word_type words[CHUNK_WORDS];
+        };
+
+        /// An empty sequence of nucleotides
+        PackedBases() : length(0) {}
+
+        /// A sequence of \a length nucleotides that are all index 0 ('T')
+        explicit PackedBases(size_type length);
+
+        /// Packs a string of nucleotides
+        explicit PackedBases(const std::string& s);
+
+        /** A sequence of \a length nucleotides, already packed into \a words.
+         *  Bits of \a words beyond \a length are ignored.
+         */
+        PackedBases(size_type length, const std::vector<word_type>& words);
+
+        /// Returns the number of nucleotides
+        size_type get_length() const { return length; }
+
+        /// Returns the number of chunks
+        size_type num_chunks() const { return chunks.size(); }
+
+        /// Returns the number of chunks needed for \a length nucleotides
+        static size_type num_chunks_for(size_type length)
+        {
+            return (length + CHUNK_NUCS - 1) / CHUNK_NUCS;
+        }
+
+        /// Returns the words in chunk \a c
+        const word_type* chunk_words(size_type c) const { return chunks[c]->words; }
+
+        /// Does chunk \a c of both sequences refer to the same memory?
+        bool shares_chunk(const PackedBases& other, size_type c) const
+        {
+            return chunks[c] == other.chunks[c];
+        }
+
+        /** Returns the nucleotide index (based on Consts::NUC_VALS) for a base
+         *  at a given position.
+         */
+        inline int base_at(size_type n) const
+        {
+            return (chunks[n / CHUNK_NUCS]->words[(n % CHUNK_NUCS) / Consts::NUC_PER_WORD] >>
+                    (Consts::NUC_BITS * (n % Consts::NUC_PER_WORD))) & Consts::NUC_MASK;
+        }
+
+        /** Sets the base at position \a n to the nucleotide index \a base.
+         *  Copies the chunk first if it is shared.
+         */
+        void set_base(size_type n, int base);
+
+        /** Overwrites the bases in [\a beg, \a end) with those of \a other.
+         *  Chunks that lie completely in the range are shared with \a other,
+         *  and only the words in the boundary chunks are copied.
+         */
+        void splice(const PackedBases& other, size_type beg, size_type end);
+
+        /// Returns the nucleotides as a string
+        std::string as_string() const;
+
+        /// Number of nucleotides that differ between two sequences
+        friend size_type distance(const PackedBases& a, const PackedBases& b);
+
+        /** Number of nucleotides that differ between two sequences, if it is
+         *  at most \a max_d.
+         *  Stops at the end of the first chunk where the count passes \a
+         *  max_d, and then returns the partial count (greater than \a max_d).
+         */
+        friend size_type bounded_distance(const PackedBases& a, const PackedBases& b,
+                                          size_type max_d);
+
+    private:
+        /// Number of nucleotides
+        size_type length;
+
+        /// The chunks, shared with other copies until written to
+        std::vector<std::shared_ptr<Chunk> > chunks;
+
+        /// Returns chunk \a c for writing, copying it first if it is shared
+        Chunk& writable_chunk(size_type c);
+    };
+}
+
+#endif // PACKED_BASES_H
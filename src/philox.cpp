@@ -0,0 +1,89 @@
+#include "philox.h"
+
+using namespace retrocombinator;
+
+namespace
+{
+    //@{
+    /// Multipliers and key increments (Weyl sequence) for Philox4x32
+    const std::uint32_t PHILOX_M0 = 0xD2511F53;
+    const std::uint32_t PHILOX_M1 = 0xCD9E8D57;
+    const std::uint32_t PHILOX_W0 = 0x9E3779B9;
+    const std::uint32_t PHILOX_W1 = 0xBB67AE85;
+    //@}
+
+    /// Number of rounds, 10 is the recommended number for Philox4x32
+    const int PHILOX_ROUNDS = 10;
+}
+
+Philox::Philox(std::uint64_t seed, std::uint32_t s1, std::uint32_t s2,
+               std::uint32_t s3) :
+    next(4)
+{
+    key[0] = static_cast<std::uint32_t>(seed);
+    key[1] = static_cast<std::uint32_t>(seed >> 32);
+    counter[0] = 0;
+    counter[1] = s1;
+    counter[2] = s2;
+    counter[3] = s3;
+}
+
+void Philox::bijection(const std::uint32_t counter[4],
+                       const std::uint32_t key[2],
+                       std::uint32_t out[4])
+{
+    std::uint32_t c[4] = { counter[0], counter[1], counter[2], counter[3] };
+    std::uint32_t k[2] = { key[0], key[1] };
+    for (int round=0; round<PHILOX_ROUNDS; ++round)
+    {
+        if (round > 0)
+        {
+            k[0] += PHILOX_W0;
+            k[1] += PHILOX_W1;
+        }
+        std::uint64_t p0 = std::uint64_t(PHILOX_M0) * c[0];
+        std::uint64_t p1 = std::uint64_t(PHILOX_M1) * c[2];
+        std::uint32_t next_c[4] = {
+            static_cast<std::uint32_t>(p1 >> 32) ^ c[1] ^ k[0],
+            static_cast<std::uint32_t>(p1),
+            static_cast<std::uint32_t>(p0 >> 32) ^ c[3] ^ k[1],
+            static_cast<std::uint32_t>(p0)
+        };
+        for (int i=0; i<4; ++i) { c[i] = next_c[i]; }
+    }
+    for (int i=0; i<4; ++i) { out[i] = c[i]; }
+}
+
+void Philox::generate_block()
+{
+    bijection(counter, key, block);
+    ++counter[0];
+    next = 0;
+}
+
+void Philox::generate(result_type* out, std::size_t n)
+{
+    for (; n > 0 && next < 4; --n)
+    {
+        *out++ = block[next++];
+    }
+    for (; n >= 4; n -= 4, out += 4)
+    {
+        bijection(counter, key, out);
+        ++counter[0];
+    }
+    for (; n > 0; --n)
+    {
+        *out++ = (*this)();
+    }
+}
+
+void Philox::discard(unsigned long long n)
+{
+    // use up what is left of the current block first
+    for (; n > 0 && next < 4; --n) { ++next; }
+    if (n == 0) { return; }
+    counter[0] += static_cast<std::uint32_t>(n / 4);
+    generate_block();
+    next = static_cast<unsigned>(n % 4);
+}
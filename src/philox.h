@@ -0,0 +1,90 @@
+/**
+ * @file
+ *
+ * \brief For the Philox class, a counter-based random number engine
+ */
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include "constants.h"
+
+#include <cstdint>
+#include <limits>
+
+namespace retrocombinator
+{
+    /** The Philox4x32-10 counter-based random number engine (Salmon et al.
+     *  2011, "Parallel Random Numbers: As Easy as 1, 2, 3").
+     *
+     *  Every block of 4 random numbers is a keyed bijection of a 128-bit
+     *  counter, so any part of the output can be computed without computing
+     *  what comes before it. The key is the seed, and the upper three words of
+     *  the counter name a stream, so that independent streams can be handed
+     *  out for different purposes and produce the same numbers whatever order
+     *  (or thread) they are used in. The lowest word of the counter counts
+     *  blocks within the stream.
+     *
+     *  Satisfies the requirements of a C++ uniform random bit generator, so it
+     *  can be used with the distributions in \<random\>.
+     */
+    class Philox
+    {
+    public:
+        /// Type of the numbers generated
+        typedef std::uint32_t result_type;
+
+        /// Smallest number generated
+        static constexpr result_type min() { return 0; }
+        /// Largest number generated
+        static constexpr result_type max()
+        {
+            return std::numeric_limits<result_type>::max();
+        }
+
+        /** An engine with a given \a seed, for the stream named by the
+         *  three words \a s1, \a s2 and \a s3.
+         */
+        explicit Philox(std::uint64_t seed = 0, std::uint32_t s1 = 0,
+                        std::uint32_t s2 = 0, std::uint32_t s3 = 0);
+
+        /// Returns the next random number in the stream
+        result_type operator()()
+        {
+            if (next == 4)
+            {
+                generate_block();
+            }
+            return block[next++];
+        }
+
+        /** Writes the next \a n random numbers in the stream to \a out.
+         *  Whole blocks are written straight to \a out.
+         */
+        void generate(result_type* out, std::size_t n);
+
+        /// Skips the next \a n random numbers in the stream
+        void discard(unsigned long long n);
+
+        /** Computes the 4 output words for a given counter and key.
+         *  This is the whole generator, the rest is bookkeeping.
+         */
+        static void bijection(const std::uint32_t counter[4],
+                              const std::uint32_t key[2],
+                              std::uint32_t out[4]);
+
+    private:
+        /// The seed
+        std::uint32_t key[2];
+        /// Block number within the stream, and the name of the stream
+        std::uint32_t counter[4];
+        /// The current block of output
+        std::uint32_t block[4];
+        /// Which word of \p block is to be returned next (4 if none are left)
+        unsigned next;
+
+        /// Fills \p block for the current counter, and moves the counter on
+        void generate_block();
+    };
+}
+
+#endif // PHILOX_H
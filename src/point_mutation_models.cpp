@@ -2,15 +2,90 @@
 
 #include "point_mutation_models.h"
 
+#include <algorithm>
+
 using namespace retrocombinator;
 
+namespace
+{
+    /** Finds the eigenvalues and eigenvectors of a symmetric matrix \a A,
+     *  with the cyclic Jacobi method.
+     *  The columns of \a V are the eigenvectors, in the same order as the
+     *  \a eigenvalues. \a A is destroyed in the process.
+     */
+    void symmetric_eigen(NucMatrix A, double eigenvalues[], NucMatrix V)
+    {
+        const int n = Consts::NUC_COUNT;
+        for (int i=0; i<n; ++i)
+        {
+            for (int j=0; j<n; ++j)
+            {
+                V[i][j] = (i == j) ? 1 : 0;
+            }
+        }
+
+        // Each rotation zeroes one off-diagonal element, and a handful of
+        // sweeps over all of them is plenty for a 4x4 matrix
+        for (int sweep=0; sweep<50; ++sweep)
+        {
+            double off_diagonal = 0;
+            for (int p=0; p<n; ++p)
+            {
+                for (int q=p+1; q<n; ++q)
+                {
+                    off_diagonal += A[p][q]*A[p][q];
+                }
+            }
+            if (off_diagonal < 1e-30) { break; }
+
+            for (int p=0; p<n; ++p)
+            {
+                for (int q=p+1; q<n; ++q)
+                {
+                    if (A[p][q] == 0) { continue; }
+
+                    double theta = (A[q][q] - A[p][p]) / (2*A[p][q]);
+                    double t = (theta >= 0 ? 1.0 : -1.0) /
+                               (fabs(theta) + sqrt(theta*theta + 1));
+                    double c = 1 / sqrt(t*t + 1);
+                    double s = t*c;
+
+                    for (int k=0; k<n; ++k)
+                    {
+                        double a_kp = A[k][p], a_kq = A[k][q];
+                        A[k][p] = c*a_kp - s*a_kq;
+                        A[k][q] = s*a_kp + c*a_kq;
+                    }
+                    for (int k=0; k<n; ++k)
+                    {
+                        double a_pk = A[p][k], a_qk = A[q][k];
+                        A[p][k] = c*a_pk - s*a_qk;
+                        A[q][k] = s*a_pk + c*a_qk;
+                    }
+                    for (int k=0; k<n; ++k)
+                    {
+                        double v_kp = V[k][p], v_kq = V[k][q];
+                        V[k][p] = c*v_kp - s*v_kq;
+                        V[k][q] = s*v_kp + c*v_kq;
+                    }
+                }
+            }
+        }
+
+        for (int i=0; i<n; ++i)
+        {
+            eigenvalues[i] = A[i][i];
+        }
+    }
+}
+
 const double (*PointMutationModel::get_Q())[Consts::NUC_COUNT]
 {
     return Q;
 }
 
 PointMutationModel::PointMutationModel(double scale) :
-    scale(scale), t_stored(0)
+    scale(scale), t_stored(0), cache(1), current(0), num_uses(0)
 {
     for(int i=0; i<Consts::NUC_COUNT; ++i)
     {
@@ -20,17 +95,83 @@ PointMutationModel::PointMutationModel(double scale) :
             P[i][j] = i == j ? 1: 0;
         }
     }
+    // P(0) is the identity whatever Q is
+    store_transition(cache[0]);
 }
 
 const double (*PointMutationModel::get_transition_matrix(double t))[Consts::NUC_COUNT]
 {
+    ++num_uses;
     // compute the transition matrix only if required
-    if (t_stored != t)
+    if (cache[current].t != t)
+    {
+        auto found = std::find_if(cache.begin(), cache.end(),
+            [t](const Transition& transition) { return transition.t == t; });
+        if (found != cache.end())
+        {
+            current = found - cache.begin();
+        }
+        else
+        {
+            t_stored = t;
+            compute_transition_matrix();
+            if (cache.size() < Consts::TRANSITION_CACHE_SIZE)
+            {
+                cache.emplace_back();
+                current = cache.size() - 1;
+            }
+            else
+            {
+                current = std::min_element(cache.begin(), cache.end(),
+                    [](const Transition& a, const Transition& b)
+                    { return a.last_used < b.last_used; }) - cache.begin();
+            }
+            store_transition(cache[current]);
+        }
+    }
+    cache[current].last_used = num_uses;
+    return cache[current].P;
+}
+
+void PointMutationModel::store_transition(Transition& transition)
+{
+    transition.t = t_stored;
+    transition.last_used = num_uses;
+    std::copy(&P[0][0], &P[0][0] + Consts::NUC_COUNT*Consts::NUC_COUNT,
+              &transition.P[0][0]);
+
+    double max_change = 0;
+    for (int i=0; i<Consts::NUC_COUNT; ++i)
     {
-        t_stored = t;
-        compute_transition_matrix();
+        transition.row_tables[i] = AliasTable(P[i], Consts::NUC_COUNT);
+        max_change = std::max(max_change, 1 - P[i][i]);
     }
-    return P;
+    max_change = std::min(max_change, 1.0);
+    transition.max_change = max_change;
+
+    for (int i=0; i<Consts::NUC_COUNT; ++i)
+    {
+        double candidate_row[Consts::NUC_COUNT];
+        double stays = 1;
+        for (int j=0; j<Consts::NUC_COUNT; ++j)
+        {
+            if (i == j) { continue; }
+            candidate_row[j] = (max_change > 0) ? P[i][j] / max_change : 0;
+            stays -= candidate_row[j];
+        }
+        candidate_row[i] = std::max(stays, 0.0);
+        transition.candidate_tables[i] = AliasTable(candidate_row, Consts::NUC_COUNT);
+    }
+}
+
+int PointMutationModel::sample_row(int from_base, RandMaths& rng) const
+{
+    return cache[current].row_tables[from_base].sample(rng.rand_real());
+}
+
+int PointMutationModel::sample_candidate(int from_base, RandMaths& rng) const
+{
+    return sample_candidate(from_base, rng.rand_real());
 }
 
 GTRModel::GTRModel(
@@ -67,12 +208,81 @@ GTRModel::GTRModel(
     Q[Consts::G][Consts::T] = G2T * pi_T;
     Q[Consts::G][Consts::C] = G2C * pi_C;
     Q[Consts::G][Consts::A] = G2A * pi_A;
+
+    if (!(pi_T > 0 && pi_C > 0 && pi_A > 0 && pi_G > 0))
+    {
+        // Only the specific models with closed forms can be used
+        return;
+    }
+
+    // Reference- Molecular Evolution: A Statistical Approach, Ziheng Yang
+    // Section 1.5.2
+    // With PI = diag(pi), B = PI^(1/2) Q PI^(-1/2) is symmetric, so
+    // B = V diag(eigenvalues) V^T with V orthogonal, and then
+    // Q = (PI^(-1/2) V) diag(eigenvalues) (V^T PI^(1/2)).
+    double pi[Consts::NUC_COUNT];
+    pi[Consts::T] = pi_T;
+    pi[Consts::C] = pi_C;
+    pi[Consts::A] = pi_A;
+    pi[Consts::G] = pi_G;
+
+    NucMatrix B;
+    NucMatrix V;
+    for (int i=0; i<Consts::NUC_COUNT; ++i)
+    {
+        for (int j=0; j<Consts::NUC_COUNT; ++j)
+        {
+            B[i][j] = sqrt(pi[i]) * Q[i][j] / sqrt(pi[j]);
+        }
+    }
+    // the two halves differ only by rounding
+    for (int i=0; i<Consts::NUC_COUNT; ++i)
+    {
+        for (int j=0; j<i; ++j)
+        {
+            B[i][j] = B[j][i] = (B[i][j] + B[j][i]) / 2;
+        }
+    }
+    symmetric_eigen(B, eigenvalues, V);
+
+    for (int i=0; i<Consts::NUC_COUNT; ++i)
+    {
+        for (int j=0; j<Consts::NUC_COUNT; ++j)
+        {
+            U[i][j] = V[i][j] / sqrt(pi[i]);
+            U_inv[i][j] = V[j][i] * sqrt(pi[j]);
+        }
+    }
 }
 
 void GTRModel::compute_transition_matrix()
 {
-    // TODO: Implement this
-    throw Exception("To be implemented");
+    if (!(pi_T > 0 && pi_C > 0 && pi_A > 0 && pi_G > 0))
+    {
+        throw Exception("GTR model needs all base frequencies to be positive");
+    }
+
+    double t = t_stored;
+
+    // P(t) = U diag(exp(eigenvalues*scale*t)) U_inv
+    double exps[Consts::NUC_COUNT];
+    for (int k=0; k<Consts::NUC_COUNT; ++k)
+    {
+        exps[k] = exp(eigenvalues[k]*scale*t);
+    }
+    for (int i=0; i<Consts::NUC_COUNT; ++i)
+    {
+        for (int j=0; j<Consts::NUC_COUNT; ++j)
+        {
+            double p = 0;
+            for (int k=0; k<Consts::NUC_COUNT; ++k)
+            {
+                p += U[i][k] * exps[k] * U_inv[k][j];
+            }
+            // rounding can take probabilities that are ~0 below 0
+            P[i][j] = std::max(p, 0.0);
+        }
+    }
 }
 
 TN93Model::TN93Model(double pi_T, double pi_C, double pi_A, double pi_G,
@@ -10,6 +10,10 @@
 #include <cmath>
 
 #include "constants.h"
+#include "alias_table.h"
+#include "rand_maths.h"
+
+#include <vector>
 
 namespace retrocombinator
 {
@@ -25,6 +29,11 @@ namespace retrocombinator
         /// Default scale for a JC69 point mutation model
         const double JC69_SCALE = 0.1;
         //@
+
+        /** How many transition matrices (for different times_per_step) a
+         *  point mutation model keeps around.
+         */
+        const size_type TRANSITION_CACHE_SIZE = 8;
     }
 
     /// To represent a model of DNA evolution through point mutations
@@ -33,7 +42,9 @@ namespace retrocombinator
     protected:
         /// The transition rate matrix (unscaled)
         NucMatrix Q;
-        /// The transition matrix for times_per_step \a t_stored
+        /** The transition matrix for times_per_step \a t_stored, as
+         *  computed by compute_transition_matrix().
+         */
         NucMatrix P;
         /// P = exp(scale * Q * time)
         double scale;
@@ -45,6 +56,43 @@ namespace retrocombinator
          */
         virtual void compute_transition_matrix() = 0;
 
+    private:
+        /// A transition matrix for some time, and tables to sample from it
+        struct Transition
+        {
+            /// The times_per_step that this is for
+            double t;
+            /// When this was last asked for, to find the least recently used
+            size_type last_used;
+            /// The transition matrix
+            NucMatrix P;
+            /// For sampling from each row of P
+            AliasTable row_tables[Consts::NUC_COUNT];
+            /// The largest probability in P of a nucleotide changing
+            double max_change;
+            /** For sampling from each row of P, divided by max_change off the
+             *  diagonal (see sample_candidate()).
+             */
+            AliasTable candidate_tables[Consts::NUC_COUNT];
+        };
+
+        /** The most recently used transition matrices.
+         *  Runs with a variable time step go back and forth between a few
+         *  times, so these are not recomputed every step.
+         */
+        std::vector<Transition> cache;
+
+        /// Which element of \p cache is for the last time asked for
+        size_type current;
+
+        /// Counts calls to get_transition_matrix(), to order the cache
+        size_type num_uses;
+
+        /** Stores P (for times_per_step \a t_stored) and tables to sample
+         *  from it in \p transition.
+         */
+        void store_transition(Transition& transition);
+
     public:
         /// Constructor that allocates memory for transition matrix
         PointMutationModel(double scale = 1);
@@ -67,6 +115,39 @@ namespace retrocombinator
          *
          */
         ReturnsNucMatrixFromDouble get_transition_matrix;
+
+        /** Picks the nucleotide that \a from_base becomes, according to the
+         *  transition matrix from the last call to get_transition_matrix(),
+         *  with random numbers drawn from \a rng.
+         *  Takes constant time.
+         */
+        int sample_row(int from_base, RandMaths& rng) const;
+
+        /** Returns the largest probability of a nucleotide changing, according
+         *  to the transition matrix from the last call to
+         *  get_transition_matrix().
+         */
+        double get_max_change_probability() const
+        {
+            return cache[current].max_change;
+        }
+
+        /** Picks the nucleotide that \a from_base becomes, given that it was
+         *  chosen as a candidate for mutation with probability
+         *  get_max_change_probability().
+         *  That is, it changes to another nucleotide with probability
+         *  P(from_base, to) / get_max_change_probability(), and otherwise stays
+         *  the same. Random numbers are drawn from \a rng. Takes constant time.
+         */
+        int sample_candidate(int from_base, RandMaths& rng) const;
+
+        /** As for sample_candidate(int, RandMaths&), but with the random number
+         *  \a u in [0, 1) given.
+         */
+        int sample_candidate(int from_base, double u) const
+        {
+            return cache[current].candidate_tables[from_base].sample(u);
+        }
     };
 
     /// General Time Reversible Model, Tavare 1986
@@ -84,7 +165,18 @@ namespace retrocombinator
         const double pi_G;
         ///@}
 
-        /// To be computed using exponentiation of Q
+        ///@{
+        /** The eigendecomposition of Q, Q = U diag(eigenvalues) U_inv.
+         *  Q is similar to a symmetric matrix because the model is time
+         *  reversible, so this is computed through the symmetric matrix, once.
+         *  Only valid if all base frequencies are positive.
+         */
+        double eigenvalues[Consts::NUC_COUNT];
+        NucMatrix U;
+        NucMatrix U_inv;
+        ///@}
+
+        /// Computed using the eigendecomposition of Q
         void compute_transition_matrix() override;
     public:
         /** 4 equilibrium base frequency parameters, 6 substitution rate
@@ -14,39 +14,65 @@ Pool::Pool(std::string sequence, size_type sequence_length,
     mutator(mutation_model),
     burster(burst_probability, burst_mean, max_total_copies,
             recomb_mean, recomb_similarity),
-    selection_threshold(selection_threshold)
+    selection_threshold(selection_threshold),
+    distances(sequence.empty() ? sequence_length : sequence.size()),
+    track_distances(false),
+    timestep(0)
 {
     Sequence::set_activity_tracker(activity_tracker);
     Sequence::renumber_sequences();
     if (!sequence.empty()) {
-        for (size_type i = 0; i < num_initial_copies; ++i) {
-            pool.emplace_back(sequence);
+        // Parse the sequence once, all copies share it as their ancestor
+        pool.emplace_back(sequence);
+        for (size_type i = 1; i < num_initial_copies; ++i) {
+            pool.emplace_back(pool.begin()->get_ancestor());
         }
     }
     else {
         // Create one random sequence
-        pool.emplace_back();
+        auto rng = RNG.stream(Consts::POOL_STREAM_TAG, timestep,
+                              Consts::RAND_INITIAL_SEQUENCE);
+        pool.emplace_back(rng);
         for (size_type i = 1; i < num_initial_copies; ++i) {
             // Initialise everything else with that
-            pool.emplace_back(pool.begin()->as_string());
+            pool.emplace_back(pool.begin()->get_ancestor());
         }
     }
 
 }
 
+void Pool::set_track_distances(bool track) {
+    if (track == track_distances) { return; }
+    track_distances = track;
+    distances = DistanceMatrix(pool.empty() ? 0 : pool.front().get_length());
+    if (!track) { return; }
+    for (const auto& seq : pool) {
+        if (distances.size() == 0) { distances.add(seq); }
+        else { distances.add_from(seq, pool.front()); }
+    }
+}
+
 void Pool::step(double time_per_step) {
-    // 1) Mutate
+    ++timestep;
+    // 1) Mutate, each sequence with its own random numbers
+    Mutator::change_list changes;
     for (auto& seq : pool) {
-        mutator.mutate_sequence(seq, time_per_step);
+        auto rng = RNG.stream(seq.get_tag(), timestep, Consts::RAND_MUTATION);
+        changes.clear();
+        mutator.mutate_sequence(seq, time_per_step, rng,
+                                track_distances ? &changes : nullptr);
+        if (track_distances) { distances.update_mutated(seq, changes); }
     }
     // 2) Burst and prune
-    burster.burst_sequences(pool);
+    burster.burst_sequences(pool, RNG, timestep,
+                            track_distances ? &distances : nullptr);
 
     // 3) Select
     if (selection_threshold > 0.0) {
         for (auto it=pool.begin(); it!=pool.end(); /* update it in loop*/)
         {
             if (it -> init_seq_similarity() < selection_threshold) {
+                if (track_distances) { distances.remove(*it); }
                 it = pool.erase(it);
             }
             else { ++it; }
@@ -54,14 +80,3 @@ void Pool::step(double time_per_step) {
     }
 }
 
-dist_type Pool::get_distance_matrix() const {
-    dist_type dist_mat;
-    for (const auto& seq_i : pool) {
-        dist_mat.emplace_back();
-        for (const auto& seq_j : pool) {
-            dist_mat.back().push_back(seq_i % seq_j);
-        }
-    }
-    return dist_mat;
-}
-
@@ -7,6 +7,7 @@
 
 #include "sequence.h"
 #include "burster.h"
+#include "distance_matrix.h"
 #include "mutator.h"
 
 namespace retrocombinator
@@ -32,6 +33,21 @@ namespace retrocombinator
         /// The current pool of sequences during our simulation
         sequence_list pool;
 
+        /** The distances between the sequences in the pool, kept up to date
+         *  if \p track_distances is set.
+         */
+        DistanceMatrix distances;
+
+        /** Whether \p distances is kept. It takes memory quadratic in the
+         *  size of the pool, so is off unless asked for.
+         */
+        bool track_distances;
+
+        /** How many times the pool has been stepped.
+         *  Names the random streams used in each step.
+         */
+        size_type timestep;
+
     public:
         /** Constructor of Sequence Pool, that gives it access to a
          *  burster/pruner and a mutator.
@@ -51,8 +67,21 @@ namespace retrocombinator
         /// What is the current state of the pool?
         const sequence_list& get_pool() const { return pool; }
 
-        /// What are the pairwise distances between sequences at this state?
-        dist_type get_distance_matrix() const;
+        /** Sets whether the distances between every two sequences of the
+         *  pool are kept up to date, as the pool changes.
+         *  This makes similarity checks (when bursting and in the output) a
+         *  lookup, at the cost of memory quadratic in the size of the pool.
+         *  Without it, sequences are compared when needed.
+         */
+        void set_track_distances(bool track);
+
+        /// Are the distances between the sequences kept up to date?
+        bool tracks_distances() const { return track_distances; }
+
+        /** What are the pairwise distances between sequences at this state?
+         *  Only holds the sequences if tracks_distances().
+         */
+        const DistanceMatrix& get_distances() const { return distances; }
     };
 }
 
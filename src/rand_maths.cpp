@@ -1,6 +1,8 @@
 #include "constants.h"
 #include "rand_maths.h"
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <numeric>
 
 // Declaration of global random number generator
@@ -15,10 +17,96 @@ namespace retrocombinator
 
 using namespace retrocombinator;
 
+namespace
+{
+    /// How many values the bulk functions convert at a time
+    const size_type BULK_BATCH_SIZE = 64;
+
+    /// Means below this are sampled by inversion, and above by PTRS
+    const double POISSON_INVERSION_MAX_MEAN = 10.0;
+    /// Binomials with fewer expected successes are sampled by inversion
+    const double BINOMIAL_INVERSION_MAX_MEAN = 10.0;
+
+    /// Converts 64 random bits into a real number in [0, 1), with 53 bits
+    inline double bits_to_uniform(std::uint64_t bits)
+    {
+        // the top 53 bits, as a multiple of 2^-53
+        return (bits >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    /** Cumulative probabilities of a Poisson distribution with a small mean,
+     *  kept for the last mean that was asked for, as the same mean is
+     *  usually used over and over.
+     */
+    struct PoissonTable
+    {
+        double mean = -1;
+        /// cdf[k] = P(X <= k), up to where the tail is negligible
+        std::vector<double> cdf;
+        /// P(X = cdf.size() - 1), to carry on past the table
+        double last_pmf = 0;
+
+        void build(double m)
+        {
+            mean = m;
+            cdf.clear();
+            double pmf = std::exp(-mean);
+            double total = pmf;
+            cdf.push_back(total);
+            for (size_type k=1; k <= mean || pmf > 1e-17; ++k)
+            {
+                pmf *= mean / k;
+                total += pmf;
+                cdf.push_back(total);
+            }
+            last_pmf = pmf;
+        }
+
+        /// The value whose cumulative probability first passes \a u
+        size_type invert(double u) const
+        {
+            size_type k = std::upper_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+            if (k < cdf.size()) { return k; }
+
+            // Past the table, where the probabilities only matter in theory
+            double total = cdf.back();
+            double pmf = last_pmf;
+            for (k = cdf.size() - 1; u >= total && pmf > 0; )
+            {
+                ++k;
+                pmf *= mean / k;
+                total += pmf;
+            }
+            return k;
+        }
+    };
+
+    /// The table for \a mean, for the calling thread
+    const PoissonTable& poisson_table(double mean)
+    {
+        static thread_local PoissonTable table;
+        if (table.mean != mean) { table.build(mean); }
+        return table;
+    }
+}
+
 RandMaths::RandMaths()
 {
     last_seed = std::chrono::system_clock::now().time_since_epoch().count();
-    re.seed(last_seed);
+    re = Philox(last_seed);
+}
+
+RandMaths::RandMaths(size_type seed, tag_type tag, size_type timestep,
+                     Consts::RandPurpose purpose) :
+    re(seed, static_cast<std::uint32_t>(tag),
+       static_cast<std::uint32_t>(timestep), static_cast<std::uint32_t>(purpose)),
+    last_seed(seed)
+{}
+
+RandMaths RandMaths::stream(tag_type tag, size_type timestep,
+                            Consts::RandPurpose purpose) const
+{
+    return RandMaths(last_seed, tag, timestep, purpose);
 }
 /*static*/ RandMaths& RandMaths::get_instance()
 {
@@ -29,20 +117,25 @@ RandMaths::RandMaths()
 void RandMaths::set_specific_seed(size_type seed)
 {
     last_seed = seed;
-    re.seed(seed);
+    re = Philox(seed);
 }
 
 void RandMaths::set_random_seed()
 {
     last_seed = std::chrono::system_clock::now().time_since_epoch().count();
-    re.seed(last_seed);
+    re = Philox(last_seed);
+}
+
+std::uint64_t RandMaths::rand_bits()
+{
+    // the same order as fill_bits()
+    std::uint64_t low = re();
+    return low | (std::uint64_t(re()) << 32);
 }
 
 bool RandMaths::rand_bit()
 {
-    static std::uniform_int_distribution<size_type> bit_gen(0, 1);
-    // implicitly convert 0 or 1 to bool
-    return bit_gen(re);
+    return (re() >> 31) != 0;
 }
 
 size_type RandMaths::rand_int(size_type low, size_type high)
@@ -53,9 +146,29 @@ size_type RandMaths::rand_int(size_type low, size_type high)
             " >= " + std::to_string(high);
         throw Exception(msg);
     }
-    using Dist = std::uniform_int_distribution<size_type>;
-    static Dist uid {};
-    return uid(re, Dist::param_type{low,high-1});
+    std::uint64_t range = high - low;
+    if (range <= 0xFFFFFFFFULL)
+    {
+        // Lemire's method: scale a 32-bit value by multiplying, and only
+        // reject values from the few low ends that would make it biased
+        std::uint64_t product = std::uint64_t(re()) * range;
+        if (std::uint32_t(product) < range)
+        {
+            std::uint32_t threshold = std::uint32_t(-std::uint32_t(range)) %
+                                      std::uint32_t(range);
+            while (std::uint32_t(product) < threshold)
+            {
+                product = std::uint64_t(re()) * range;
+            }
+        }
+        return low + size_type(product >> 32);
+    }
+    // Wide ranges are rare, so take the bits needed and reject the rest
+    std::uint64_t mask = range - 1;
+    for (unsigned shift = 1; shift < 64; shift *= 2) { mask |= mask >> shift; }
+    std::uint64_t x;
+    do { x = rand_bits() & mask; } while (x >= range);
+    return low + size_type(x);
 }
 
 double RandMaths::rand_real(double low /*= 0.0*/, double high /*= 1.0*/)
@@ -66,9 +179,9 @@ double RandMaths::rand_real(double low /*= 0.0*/, double high /*= 1.0*/)
             " >= " + std::to_string(high);
         throw Exception(msg);
     }
-    using Dist = std::uniform_real_distribution<double>;
-    static Dist urd {};
-    return urd(re, Dist::param_type{low, high});
+    double x = low + (high - low) * bits_to_uniform(rand_bits());
+    // rounding can reach the upper bound
+    return x < high ? x : std::nextafter(high, low);
 }
 
 size_type RandMaths::rand_poisson(double mean)
@@ -77,12 +190,284 @@ size_type RandMaths::rand_poisson(double mean)
     {
         throw Exception("mean is <= 0 for Poisson distribution");
     }
-    using Dist = std::poisson_distribution<size_type>;
-    static Dist pd {};
-    return pd(re, Dist::param_type{mean});
+    if (mean < POISSON_INVERSION_MAX_MEAN)
+    {
+        // Inversion, with the table of cumulative probabilities
+        return poisson_table(mean).invert(bits_to_uniform(rand_bits()));
+    }
+
+    // PTRS, the transformed rejection method of Hoermann (1993)
+    double sqrt_mean = std::sqrt(mean);
+    double log_mean = std::log(mean);
+    double b = 0.931 + 2.53 * sqrt_mean;
+    double a = -0.059 + 0.02483 * b;
+    double inv_alpha = 1.1239 + 1.1328 / (b - 3.4);
+    double v_r = 0.9277 - 3.6224 / (b - 2);
+    while (true)
+    {
+        double u = bits_to_uniform(rand_bits()) - 0.5;
+        double v = bits_to_uniform(rand_bits());
+        double us = 0.5 - std::fabs(u);
+        double k = std::floor((2 * a / us + b) * u + mean + 0.43);
+        if (us >= 0.07 && v <= v_r)
+        {
+            return size_type(k);
+        }
+        if (k < 0 || (us < 0.013 && v > us))
+        {
+            continue;
+        }
+        if (std::log(v) + std::log(inv_alpha) - std::log(a / (us * us) + b) <=
+            -mean + k * log_mean - std::lgamma(k + 1))
+        {
+            return size_type(k);
+        }
+    }
+}
+
+size_type RandMaths::rand_binomial(size_type n, double p)
+{
+    if (p < 0 || p > 1)
+    {
+        throw Exception("p is not in [0, 1] for binomial distribution");
+    }
+    // Sample the rarer of successes and failures
+    if (p > 0.5)
+    {
+        return n - rand_binomial(n, 1 - p);
+    }
+    if (n == 0 || p == 0)
+    {
+        return 0;
+    }
+
+    double q = 1 - p;
+    if (n * p < BINOMIAL_INVERSION_MAX_MEAN)
+    {
+        // Inversion, walking up from 0 (BINV, Kachitvichyanukul and
+        // Schmeiser 1988)
+        double s = p / q;
+        double a = (n + 1) * s;
+        double pmf = std::pow(q, double(n));
+        double u = bits_to_uniform(rand_bits());
+        size_type k = 0;
+        while (u > pmf && k < n)
+        {
+            u -= pmf;
+            ++k;
+            pmf *= a / k - s;
+        }
+        return k;
+    }
+
+    // BTRS, the transformed rejection method of Hoermann (1993)
+    double spq = std::sqrt(n * p * q);
+    double b = 1.15 + 2.53 * spq;
+    double a = -0.0873 + 0.0248 * b + 0.01 * p;
+    double c = n * p + 0.5;
+    double v_r = 0.92 - 4.2 / b;
+    double alpha = (2.83 + 5.1 / b) * spq;
+    double log_pq = std::log(p / q);
+    double m = std::floor((n + 1) * p);
+    double h = std::lgamma(m + 1) + std::lgamma(n - m + 1);
+    while (true)
+    {
+        double u = bits_to_uniform(rand_bits()) - 0.5;
+        double v = bits_to_uniform(rand_bits());
+        double us = 0.5 - std::fabs(u);
+        double k = std::floor((2 * a / us + b) * u + c);
+        if (k < 0 || k > n)
+        {
+            continue;
+        }
+        if (us >= 0.07 && v <= v_r)
+        {
+            return size_type(k);
+        }
+        v = std::log(v * alpha / (a / (us * us) + b));
+        if (v <= h - std::lgamma(k + 1) - std::lgamma(n - k + 1) +
+                 (k - m) * log_pq)
+        {
+            return size_type(k);
+        }
+    }
+}
+
+size_type RandMaths::rand_geometric(double p)
+{
+    size_type failures;
+    fill_geometric(&failures, 1, p);
+    return failures;
+}
+
+size_type RandMaths::rand_hypergeometric(size_type good, size_type bad,
+                                          size_type draws)
+{
+    if (draws > good + bad)
+    {
+        throw Exception("Cannot draw more items than there are");
+    }
+    size_type low = draws > bad ? draws - bad : 0;
+    size_type high = std::min(draws, good);
+    if (low == high)
+    {
+        return low;
+    }
+
+    // Ratio P(x+1) / P(x) of consecutive probabilities
+    auto ratio = [=](size_type x)
+    {
+        return double(good - x) * double(draws - x) /
+               (double(x + 1) * double(bad + x + 1 - draws));
+    };
+    auto log_choose = [](size_type n, size_type k)
+    {
+        return std::lgamma(n + 1.0) - std::lgamma(k + 1.0) -
+               std::lgamma(n - k + 1.0);
+    };
+
+    size_type mode = size_type(double(draws + 1) * double(good + 1) /
+                               double(good + bad + 2));
+    mode = std::min(std::max(mode, low), high);
+    double p_mode = std::exp(log_choose(good, mode) +
+                             log_choose(bad, draws - mode) -
+                             log_choose(good + bad, draws));
+
+    // Take away probabilities from the uniform, alternately above and below
+    // the mode, until it drops to 0
+    double u = rand_real() - p_mode;
+    if (u <= 0)
+    {
+        return mode;
+    }
+    size_type down = mode, up = mode;
+    double p_down = p_mode, p_up = p_mode;
+    while (down > low || up < high)
+    {
+        if (up < high)
+        {
+            p_up *= ratio(up);
+            ++up;
+            u -= p_up;
+            if (u <= 0) { return up; }
+        }
+        if (down > low)
+        {
+            p_down /= ratio(down - 1);
+            --down;
+            u -= p_down;
+            if (u <= 0) { return down; }
+        }
+    }
+    // Only reached through rounding errors
+    return mode;
+}
+
+void RandMaths::fill_bits(std::uint64_t* out, size_type n)
+{
+    Philox::result_type halves[2*BULK_BATCH_SIZE];
+    while (n > 0)
+    {
+        size_type m = std::min(n, BULK_BATCH_SIZE);
+        re.generate(halves, 2*m);
+        for (size_type i=0; i<m; ++i)
+        {
+            out[i] = std::uint64_t(halves[2*i]) |
+                     (std::uint64_t(halves[2*i + 1]) << 32);
+        }
+        out += m;
+        n -= m;
+    }
+}
+
+void RandMaths::fill_uniform(double* out, size_type n)
+{
+    std::uint64_t words[BULK_BATCH_SIZE];
+    while (n > 0)
+    {
+        size_type m = std::min(n, BULK_BATCH_SIZE);
+        fill_bits(words, m);
+        for (size_type i=0; i<m; ++i)
+        {
+            out[i] = bits_to_uniform(words[i]);
+        }
+        out += m;
+        n -= m;
+    }
+}
+
+void RandMaths::fill_geometric(size_type* out, size_type n, double p)
+{
+    if (p <= 0 || p > 1)
+    {
+        throw Exception("p is not in (0, 1] for geometric distribution");
+    }
+    if (p == 1)
+    {
+        std::fill(out, out + n, 0);
+        return;
+    }
+    double log_q = std::log1p(-p);
+    double u[BULK_BATCH_SIZE];
+    while (n > 0)
+    {
+        size_type m = std::min(n, BULK_BATCH_SIZE);
+        fill_uniform(u, m);
+        for (size_type i=0; i<m; ++i)
+        {
+            // by inversion, with a uniform value in (0, 1] so that the log is
+            // finite
+            double failures = std::floor(std::log(1.0 - u[i]) / log_q);
+            out[i] = failures >= double(std::numeric_limits<size_type>::max()) ?
+                     std::numeric_limits<size_type>::max() : size_type(failures);
+        }
+        out += m;
+        n -= m;
+    }
+}
+
+void RandMaths::fill_poisson(size_type* out, size_type n, double mean)
+{
+    if (mean <= 0)
+    {
+        throw Exception("mean is <= 0 for Poisson distribution");
+    }
+    if (mean >= POISSON_INVERSION_MAX_MEAN)
+    {
+        // PTRS rejects a varying number of draws, so takes them one by one
+        for (size_type i=0; i<n; ++i)
+        {
+            out[i] = rand_poisson(mean);
+        }
+        return;
+    }
+
+    // Inversion takes exactly one uniform value per draw, so look the table
+    // up once and invert uniform values a batch at a time
+    const PoissonTable& table = poisson_table(mean);
+    double u[BULK_BATCH_SIZE];
+    while (n > 0)
+    {
+        size_type m = std::min(n, BULK_BATCH_SIZE);
+        fill_uniform(u, m);
+        for (size_type i=0; i<m; ++i)
+        {
+            out[i] = table.invert(u[i]);
+        }
+        out += m;
+        n -= m;
+    }
+}
+
+std::vector<size_type> RandMaths::sample_without_replacement(size_type low, size_type high, size_type m)
+{
+    std::vector<size_type> sample(m);
+    sample_without_replacement(low, high, m, sample.data());
+    return sample;
 }
 
-std::set<size_type> RandMaths::sample_without_replacement(size_type low, size_type high, size_type m)
+void RandMaths::sample_without_replacement(size_type low, size_type high,
+                                           size_type m, size_type* out)
 {
     if (low >= high)
     {
@@ -94,12 +479,40 @@ std::set<size_type> RandMaths::sample_without_replacement(size_type low, size_ty
     {
         throw Exception("Sample space is too small to pick from");
     }
-    std::set<size_type> s;
-    while(s.size() != m)
+    size_type range = high - low;
+    if (m == 0)
+    {
+        return;
+    }
+    if (m <= range / m)
+    {
+        // Floyd's algorithm: every step adds exactly one new value, and with
+        // few values a linear scan is the cheapest membership test
+        size_type filled = 0;
+        for (size_type j = range - m; j < range; ++j, ++filled)
+        {
+            size_type t = low + rand_int(0, j+1);
+            if (std::find(out, out + filled, t) != out + filled)
+            {
+                t = low + j;
+            }
+            out[filled] = t;
+        }
+        std::sort(out, out + m);
+    }
+    else
     {
-        s.insert(rand_int(low, high));
+        // Selection sampling: keep each value with probability
+        // (number still needed) / (number still left)
+        size_type chosen = 0;
+        for (size_type i = 0; chosen < m; ++i)
+        {
+            if (rand_real() * (range - i) < m - chosen)
+            {
+                out[chosen++] = low + i;
+            }
+        }
     }
-    return s;
 }
 
 std::pair<size_type, size_type> RandMaths::sample_distinct_pair(size_type low, size_type high)
@@ -157,16 +570,17 @@ std::vector<size_type> RandMaths::choose_items(std::vector<size_type> items,
     if(items.size() <= 0) {
         throw Exception("Number of items needs to be strictly positive");
     }
-    if (long(num_picks) >= std::accumulate(items.begin(), items.end(), 0)) {
+    size_type num_left = std::accumulate(items.begin(), items.end(), size_type(0));
+    if (num_picks >= num_left) {
         return items;
     }
 
     std::vector<size_type> picks(items.size(), 0);
 
-    for (size_type i=0; i<num_picks; ++i) {
-        auto pick = choose_event<size_type>(items);
-        picks[pick] += 1;
-        items[pick] -= 1;
+    for (size_type i=0; i<items.size() && num_picks > 0; ++i) {
+        num_left -= items[i];
+        picks[i] = rand_hypergeometric(items[i], num_left, num_picks);
+        num_picks -= picks[i];
     }
 
     return picks;
@@ -8,28 +8,68 @@
 #define RAND_MATHS_H
 
 #include "constants.h"
+#include "philox.h"
+#include "weighted_sampler.h"
 
 #include <chrono>
-#include <random>
-#include <set>
+#include <cstdint>
+#include <numeric>
 #include <vector>
 
 namespace retrocombinator
 {
+    namespace Consts {
+
+        /** What a stream of random numbers (see RandMaths::stream()) is used
+         *  for.
+         *  Together with a sequence tag and a timestep, this names the stream.
+         */
+        enum RandPurpose
+        {
+            RAND_INITIAL_SEQUENCE = 1,  ///< Creating a random initial sequence
+            RAND_MUTATION,              ///< Mutating a sequence
+            RAND_BURST,                 ///< Whether and how much a sequence bursts
+            RAND_RECOMBINATION,         ///< Creating the copies of a sequence
+            RAND_PRUNING                ///< Which sequences survive
+        };
+
+        /** Tag used for streams that belong to the whole pool rather than to
+         *  one sequence.
+         *  Sequences are tagged from 1, so this never clashes.
+         */
+        const tag_type POOL_STREAM_TAG = 0;
+    }
+
     /** For all maths helper functions that use random number generation.
-     *  This is implemented as a singleton that can either be specifically
+     *
+     *  There is one global instance (\p RNG) that can either be specifically
      *  seeded (for testing and debugging) or can be randomly seeded (for
-     *  simulations).
+     *  simulations). The simulation itself draws from independent streams
+     *  that are derived from that seed (see stream()), which are passed to
+     *  whatever needs random numbers, so that the numbers each part of the
+     *  simulation sees do not depend on what order things are done in.
+     *
+     *  The distributions are implemented here rather than taken from
+     *  <random>, whose algorithms differ between standard libraries, so that
+     *  every standard library runs the same algorithm on the same random
+     *  bits. The uniform draws (rand_bits(), rand_int(), rand_real() and
+     *  their bulk versions) only use integer and basic floating point
+     *  arithmetic, so they are identical everywhere. The other distributions
+     *  also call std::exp, std::log, std::pow or std::lgamma, which are not
+     *  correctly rounded and can differ in their last bit between maths
+     *  libraries. That very rarely changes a result, but it can, so those
+     *  draws (and simulations that use them) are only guaranteed to repeat
+     *  with the same maths library.
      */
     class RandMaths
     {
     private:
         /** Engine that produces random numbers for all functions that require
          *  them.
-         *  This is seeded during initialisation of the class, and once set,
-         *  its RNG is shared by all other parts of the code that require it.
+         *  A counter-based engine, so that streams are cheap to create and
+         *  independent of each other.
          */
-        std::mt19937 re;
+        Philox re;
 
         /** Last seed for the random engine, either by the user or by the
          *  system.
@@ -40,10 +80,14 @@ namespace retrocombinator
         size_type last_seed;
 
         /** Constructor, which seeds the random engine with system time.
-         *  Is private because we want this to be a singleton.
+         *  Is private because there is only one global generator.
          */
         RandMaths();
 
+        /// Constructor for a stream, see stream()
+        RandMaths(size_type seed, tag_type tag, size_type timestep,
+                  Consts::RandPurpose purpose);
+
     public:
 
         /** Returns an instance of a RandMaths class, after seeding it with
@@ -55,7 +99,8 @@ namespace retrocombinator
         static RandMaths& get_instance();
 
         //@{
-        /** Delete copy constructors as want RandMaths to be a singleton.
+        /** Delete copy constructors, as a copy would repeat the same random
+         *  numbers.
          *  The reason these are public is because most compilers check for
          *  private-ness before they check to see if functions are deleted, and
          *  we want our error messages to be helpful if we create a new
@@ -65,6 +110,22 @@ namespace retrocombinator
         void operator=(RandMaths const&) = delete;
         //@}
 
+        //@{
+        /** But make streams moveable, so that they can be returned.
+         */
+        RandMaths(RandMaths&&) = default;
+        RandMaths& operator=(RandMaths&&) = default;
+        //@}
+
+        /** Returns an independent stream of random numbers, named by the tag
+         *  of a sequence, a timestep and what the numbers are for.
+         *  The stream only depends on the last seed and on its name, so the
+         *  same stream can be recreated anywhere, and streams can be used in
+         *  parallel. Tags and timesteps are taken modulo 2^32.
+         */
+        RandMaths stream(tag_type tag, size_type timestep,
+                         Consts::RandPurpose purpose) const;
+
         /** Uses a user-specified seed for RNG.
          *  This can be undone by calling \p set_random_seed()
          */
@@ -80,32 +141,94 @@ namespace retrocombinator
          */
         size_type get_last_seed() const { return last_seed; }
 
+        /// Generates 64 random bits
+        std::uint64_t rand_bits();
+
         /** Generates a random true/false value.
          */
         bool rand_bit();
 
         /** Generates a random integer within a range.
          *  The bounds are [inclusive_low, exclusive_high).
+         *  Uses Lemire's multiply-and-reject method, so that ranges that are
+         *  not powers of 2 are not biased.
          */
         size_type rand_int(size_type low, size_type high);
 
         /** Generates a random real number within a range.
          *  The bounds are [inclusive_low, exclusive high).
+         *  Has 53 random bits, as for fill_uniform().
          */
         double rand_real(double low = 0.0, double high = 1.0);
 
         /** Chooses a number sampled from a Poisson distribution.
          *  Takes the mean as a parameter.
+         *  Small means are sampled by inversion, from a table that is kept
+         *  for the last mean, and large ones by transformed rejection (PTRS).
          */
         size_type rand_poisson(double mean);
 
+        /** Chooses a number sampled from a binomial distribution.
+         *  This is the number of successes in \a n trials that each succeed
+         *  with probability \a p.
+         *  Sampled by inversion when few successes are expected, and by
+         *  transformed rejection (BTRS) otherwise.
+         */
+        size_type rand_binomial(size_type n, double p);
+
+        /** Chooses a number sampled from a geometric distribution.
+         *  This is the number of failures before the first success, when each
+         *  trial succeeds with probability \a p.
+         */
+        size_type rand_geometric(double p);
+
+        /** Chooses a number sampled from a hypergeometric distribution.
+         *  This is the number of good items among \a draws items picked
+         *  without replacement from \a good good items and \a bad bad ones.
+         *
+         *  Sampled by inversion, searching outwards from the mode, so that
+         *  the expected time grows with the standard deviation.
+         */
+        size_type rand_hypergeometric(size_type good, size_type bad,
+                                      size_type draws);
+
+        //@{
+        /** Bulk versions of the functions above, which fill \a out with \a n
+         *  values at once.
+         *  These take the engine's output a block at a time and convert it in
+         *  a tight loop, rather than going through a distribution object for
+         *  every value.
+         */
+        /// Words of 64 random bits
+        void fill_bits(std::uint64_t* out, size_type n);
+        /// Random real numbers in [0, 1), with 53 random bits each
+        void fill_uniform(double* out, size_type n);
+        /// Samples from a geometric distribution, as for rand_geometric()
+        void fill_geometric(size_type* out, size_type n, double p);
+        /** Samples from a Poisson distribution, as for rand_poisson(), and
+         *  giving the same values as calling it \a n times.
+         *  Means below 10 use the inversion table, with the uniform values
+         *  generated in batches.
+         */
+        void fill_poisson(size_type* out, size_type n, double mean);
+        //@}
+
         /** Samples \a m integers within a range, without replacement.
          *  The bounds are [inclusive_low, exclusive high).
          *  The integers are returned in ascending order.
+         *
+         *  Uses Floyd's algorithm when \a m is small compared to the range,
+         *  and selection sampling (one pass over the range) otherwise.
+         */
+        std::vector<size_type> sample_without_replacement(size_type low,
+                                                          size_type high,
+                                                          size_type m);
+
+        /** As for sample_without_replacement(size_type, size_type, size_type),
+         *  but writes the integers to \a out, which must have room for \a m.
          */
-        std::set<size_type> sample_without_replacement(size_type low,
-                                                       size_type high,
-                                                       size_type m);
+        void sample_without_replacement(size_type low, size_type high,
+                                        size_type m, size_type* out);
 
         /** Samples a non-diagonal pair (2 distinct values) within a range.
          *  The bounds for each value are [inclusive_low, exclusive high).
@@ -139,7 +262,7 @@ namespace retrocombinator
             }
             double rand_num = rand_real();
             // some proportion of the overall sum
-            double target = rand_num * std::accumulate(events.begin(), events.end(), 0);
+            double target = rand_num * std::accumulate(events.begin(), events.end(), 0.0);
             double running_total = 0;
             for (size_type i=0; i<events.size(); ++i)
             {
@@ -158,6 +281,7 @@ namespace retrocombinator
          *      \a picks_i is the number of times event \p i was chosen.
          *
          *  Takes the *relative* probabilities of each of the events as input.
+         *  The picks are drawn in one batch from a WeightedSampler.
          */
         template<typename T>
         std::vector<size_type> choose_events(std::vector<T> events,
@@ -166,49 +290,15 @@ namespace retrocombinator
             if(events.size() <= 0) {
                 throw Exception("Number of events needs to be strictly positive");
             }
-            // Make the (relative) probabilities cumulative
-            std::vector<double> events_cum(events.size(), 0);
-            double running_total = 0;
-            for (size_type i=0; i<events.size(); ++i) {
-                events_cum[i] = events[i] + running_total;
-                running_total = events_cum[i];
-            }
-
-            // running_total now contains the sum of all (relative) probabilities
-
-            std::vector<size_type> picks(events_cum.size(), 0);
-
-            for (size_type i=0; i<num_picks; ++i) {
-                double target = rand_real() * running_total;
-
-                // binary search on the sorted array to see which event was chosen
-                size_type beg = 0;
-                size_type end = events_cum.size() - 1;
-                size_type mid;
-
-                while (beg <= end) {
-                    mid = (beg + end) / 2;
-
-                    if(target > events_cum[mid]) {
-                        // mid *must* be < end
-                        beg = mid + 1;
-                    } else {
-                        if (mid == 0) {
-                            picks[0] += 1;
-                            break;
-                        }
-                        else if (target > events_cum[mid-1]) {
-                            // Need strictly bigger, if equal then P(mid) was 0
-                            picks[mid] += 1;
-                            break;
-                        }
-                        else {
-                            end = mid - 1;
-                        }
-                    }
-                }
+            WeightedSampler sampler(
+                std::vector<double>(events.begin(), events.end()));
+            std::vector<double> us(num_picks);
+            fill_uniform(us.data(), num_picks);
+
+            std::vector<size_type> picks(events.size(), 0);
+            for (auto event : sampler.sample_sorted(us)) {
+                picks[event] += 1;
             }
-
             return picks;
         }
 
@@ -223,6 +313,10 @@ namespace retrocombinator
          *  If the number of items to be picked is larger than we have
          *  available, all items are picked and so we just return the original
          *  list given to us.
+         *
+         *  The picks are sampled one type at a time, with the number of picks
+         *  of a type drawn from a hypergeometric distribution conditional on
+         *  the picks of the types before it.
          */
         std::vector<size_type> choose_items(std::vector<size_type> items,
                                             size_type num_picks);
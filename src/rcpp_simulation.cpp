@@ -15,7 +15,8 @@ void rcpp_simulate_evolution(
     double recomb_mean, double recomb_similarity,
     double selection_threshold,
     double family_coherence, size_t max_num_representatives,
-    size_t num_steps, double time_per_step,
+    size_t family_threads, size_t family_update_cadence, double family_update_change,
+    size_t num_steps, double time_per_step, bool track_distances,
     std::string filename_out,
     size_t num_init_dist, size_t num_pair_dist,
     size_t num_fam_size, size_t num_fam_dist,
@@ -36,7 +37,9 @@ void rcpp_simulate_evolution(
             recomb_mean, recomb_similarity,
             selection_threshold,
             family_coherence, max_num_representatives,
-            num_steps, time_per_step,
+            family_threads,
+            family_update_cadence, family_update_change,
+            num_steps, time_per_step, track_distances,
             filename_out,
             num_init_dist, num_pair_dist,
             num_fam_size, num_fam_dist,
@@ -10,7 +10,7 @@ namespace retrocombinator
 
 using namespace retrocombinator;
 
-Representative::Representative(std::string raw_sequence,
+Representative::Representative(PackedBases raw_sequence,
         size_type num_mutations, size_type creation_timestep):
     tag(Representative::global_representative_count + 1),
     raw_sequence(raw_sequence), num_mutations(num_mutations),
@@ -18,3 +18,8 @@ Representative::Representative(std::string raw_sequence,
 {
     ++Representative::global_representative_count;
 }
+
+void Representative::renumber_representatives(tag_type new_start_tag)
+{
+    Representative::global_representative_count = new_start_tag - 1;
+}
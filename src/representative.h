@@ -5,7 +5,7 @@
 #define REPRESENTATIVE_H
 
 #include "constants.h"
-#include <string>
+#include "packed_bases.h"
 
 namespace retrocombinator
 {
@@ -18,8 +18,11 @@ namespace retrocombinator
         /// How to identify this representative?
         const tag_type tag;
 
-        /// What the sequence actually is
-        const std::string raw_sequence;
+        /** What the sequence actually is.
+         *  Packed like the sequences in the pool, and sharing chunks with the
+         *  sequence it was taken from.
+         */
+        const PackedBases raw_sequence;
 
         /// Distance to initial sequence
         const size_type num_mutations;
@@ -29,8 +32,15 @@ namespace retrocombinator
 
 
         /// Simple plain-old-data constructor
-        Representative(std::string raw_sequence, size_type num_mutations,
+        Representative(PackedBases raw_sequence, size_type num_mutations,
                        size_type creation_timestep);
+
+        /** Explicitly update the global representative count to start from a
+         *  particular number.
+         *  new_start_tag will be given to the next representative created.
+         *  Used when running multiple simulations one after the other.
+         */
+        static void renumber_representatives(tag_type new_start_tag = 1);
     private:
         /** An internal counter that is incremented every time a centroid is
          *  created.
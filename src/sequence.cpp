@@ -1,10 +1,11 @@
 #include "sequence.h"
-#include "rand_maths.h"
+#include "hamming.h"
 #include "utilities.h"
 
 #include <cctype>
 #include <iterator>
 #include <algorithm>
+#include <limits>
 #include <string>
 
 namespace retrocombinator
@@ -14,58 +15,65 @@ namespace retrocombinator
     tag_type Sequence::global_sequence_count = 0;
     // Dummy activity tracker
     ActivityTracker Sequence::activity_tracker = ActivityTracker(0, 0, 0.0);
+    double Sequence::sparse_divergence = Consts::SPARSE_DIVERGENCE_DEFAULT;
 }
 
 namespace retrocombinator
 {
     size_type operator *(const Sequence& s1, const Sequence& s2)
     {
-        if (s1.get_length() != s2.get_length()) {
-            throw Exception("Cannot compare sequences of different lengths.");
-        }
-        size_type differences = 0;
-        for (size_type i=0; i<s1.get_length(); ++i)
-        {
-            if (s1.char_at(i) != s2.char_at(i))
-            {
-                ++differences;
-            }
-        }
-        return differences;
+        return s1.distance_to(s2, std::numeric_limits<size_type>::max());
     }
 
-    size_type operator *(const Sequence& s1, std::string s2)
+    size_type operator *(const Sequence& s1, const std::string& s2)
     {
-        if (s1.get_length() != s2.size()) {
-            throw Exception("Cannot compare sequences of different lengths.");
-        }
-        size_type differences = 0;
+        return s1.distance_to(PackedBases(s2), std::numeric_limits<size_type>::max());
+    }
 
-        for (size_type i=0; i<s1.get_length(); ++i)
-        {
-            if (s1.char_at(i) != s2[i])
-            {
-                ++differences;
-            }
-        }
-        return differences;
+    size_type operator *(const Sequence& s1, const PackedBases& s2)
+    {
+        return s1.distance_to(s2, std::numeric_limits<size_type>::max());
     }
 
-    size_type operator *(std::string s1, std::string s2)
+    size_type operator *(const std::string& s1, const std::string& s2)
     {
-        if (s1.size() != s2.size()) {
-            throw Exception("Cannot compare sequences of different lengths.");
-        }
-        size_type differences = 0;
+        return distance(PackedBases(s1), PackedBases(s2));
+    }
 
-        for (size_type i=0; i<s1.size(); ++i)
-        {
-            if (s1[i] != s2[i])
-            {
-                ++differences;
-            }
-        }
-        return differences;
+    size_type bounded_distance(const Sequence& s1, const Sequence& s2,
+                               size_type max_d)
+    {
+        return s1.distance_to(s2, max_d);
+    }
+
+    size_type bounded_distance(const Sequence& s1, const std::string& s2,
+                               size_type max_d)
+    {
+        return s1.distance_to(PackedBases(s2), max_d);
+    }
+
+    size_type bounded_distance(const Sequence& s1, const PackedBases& s2,
+                               size_type max_d)
+    {
+        return s1.distance_to(s2, max_d);
+    }
+
+    bool within_distance(const Sequence& s1, const Sequence& s2,
+                         size_type max_d)
+    {
+        return s1.distance_to(s2, max_d) <= max_d;
+    }
+
+    bool within_distance(const Sequence& s1, const std::string& s2,
+                         size_type max_d)
+    {
+        return s1.distance_to(PackedBases(s2), max_d) <= max_d;
+    }
+
+    bool within_distance(const Sequence& s1, const PackedBases& s2,
+                         size_type max_d)
+    {
+        return s1.distance_to(s2, max_d) <= max_d;
     }
 
     double operator %(const Sequence& s1, const Sequence& s2)
@@ -75,7 +83,7 @@ namespace retrocombinator
         }
         return (double(s1*s2))/double(s1.get_length());
     }
-    double operator %(const Sequence& s1, std::string s2)
+    double operator %(const Sequence& s1, const std::string& s2)
     {
         if (s1.get_length() != s2.size()) {
             throw Exception("Cannot compare sequences of different lengths.");
@@ -83,7 +91,7 @@ namespace retrocombinator
         return (double(s1*s2))/double(s1.get_length());
     }
 
-    double operator %(std::string s1, std::string s2)
+    double operator %(const std::string& s1, const std::string& s2)
     {
         if (s1.size() != s2.size()) {
             throw Exception("Cannot compare sequences of different lengths.");
@@ -101,33 +109,74 @@ void Sequence::renumber_sequences(tag_type new_start_tag)
 
 void Sequence::set_activity_tracker(ActivityTracker activity_tracker_)
 {
+    // positions of mutations are stored in 32 bits
+    if (activity_tracker_.get_sequence_length() >
+            std::numeric_limits<std::uint32_t>::max()) {
+        throw Exception("Sequence length is too long to keep track of mutations");
+    }
     Sequence::activity_tracker = activity_tracker_;
 }
 
+void Sequence::set_sparse_divergence(double sparse_divergence_)
+{
+    if (sparse_divergence_ < 0 || sparse_divergence_ > 1) {
+        throw Exception("Sparse divergence threshold must be between 0 and 1");
+    }
+    Sequence::sparse_divergence = sparse_divergence_;
+}
+
 std::string Sequence::as_string() const
 {
-    // bases.size() should be an exact multiple of 2
-    std::string s(bases.size()/2, ' ');
+    if (!sparse) { return bases.as_string(); }
 
-    for(size_type i=0; i<s.size(); ++i)
+    std::string s = ancestor->as_string();
+    for (const auto& m : mutations)
     {
-        s[i] = Consts::NUC_BOOL2CHAR(std::make_pair(bases[2*i], bases[2*i+1]));
+        s[m.position] = m.current;
     }
     return s;
 }
-Sequence::Sequence() :
+
+PackedBases Sequence::dense_bases() const
+{
+    if (!sparse) { return bases; }
+
+    PackedBases filled(*ancestor);
+    for (const auto& m : mutations)
+    {
+        filled.set_base(m.position, Consts::NUC_CHAR2INT(m.current));
+    }
+    return filled;
+}
+
+void Sequence::densify_if_diverged()
+{
+    if (sparse && !(mutations.size() < sparse_divergence * get_length()))
+    {
+        bases = dense_bases();
+        sparse = false;
+    }
+}
+
+Sequence::Sequence(RandMaths& rng) :
 
     tag(Sequence::global_sequence_count + 1),
     parent_tags(Consts::SEQUENCE_CREATED_RANDOMLY_TAG, Consts::SEQUENCE_CREATED_RANDOMLY_TAG),
-    bases(2*activity_tracker.get_sequence_length(), false) // assign 2n because we have 2 bits per nucleotide base
+    sparse(true)
 {
     ++Sequence::global_sequence_count;
 
-    for (size_type i=0; i<bases.size(); ++i)
-    {
-        bases[i] = RNG.rand_bit();
-    }
+    // Every pair of random bits is a random nucleotide, so the packed words
+    // can be drawn directly
+    size_type length = activity_tracker.get_sequence_length();
+    std::vector<word_type> words(
+        (length + Consts::NUC_PER_WORD - 1) / Consts::NUC_PER_WORD);
+    rng.fill_bits(words.data(), words.size());
+    ancestor = std::make_shared<const PackedBases>(length, words);
+    this->num_critical = 0;
+    this->num_changes = 0;
     this->active_status = true;
+    densify_if_diverged();
 }
 
 Sequence::Sequence(std::string s):
@@ -141,19 +190,38 @@ Sequence::Sequence(std::string s):
                 "does not match sequence length" +
                 std::to_string(activity_tracker.get_sequence_length()));
     }
-    bases.assign(2*s.size(), false);
+    ancestor = std::make_shared<const PackedBases>(s);
+    sparse = true;
+    this->num_critical = 0;
+    this->num_changes = 0;
+    this->active_status = true;
+    densify_if_diverged();
+}
 
-    for (size_type i=0; i<s.size(); ++i)
-    {
-        auto bits = Consts::NUC_CHAR2BOOL(s[i]);
-        bases[2*i]   = bits.first;
-        bases[2*i+1] = bits.second;
+Sequence::Sequence(std::shared_ptr<const PackedBases> ancestor_):
+    tag(Sequence::global_sequence_count + 1),
+    parent_tags(Consts::SEQUENCE_INITIALISED_EXTERNALLY_TAG,
+                       Consts::SEQUENCE_INITIALISED_EXTERNALLY_TAG),
+    ancestor(ancestor_),
+    sparse(true)
+{
+    ++Sequence::global_sequence_count;
+    if (!ancestor) {
+        throw Exception("Cannot copy a sequence without an initial sequence");
     }
+    if (ancestor->get_length() != activity_tracker.get_sequence_length()) {
+        throw Exception("Sequence length " + std::to_string(ancestor->get_length()) +
+                "does not match sequence length" +
+                std::to_string(activity_tracker.get_sequence_length()));
+    }
+    this->num_critical = 0;
+    this->num_changes = 0;
     this->active_status = true;
+    densify_if_diverged();
 }
 
 Sequence::Sequence(const Sequence& s1, const Sequence& s2,
-                   size_type num_template_switches):
+                   size_type num_template_switches, RandMaths& rng):
     tag(Sequence::global_sequence_count + 1),
     parent_tags(s1.get_tag(), s2.get_tag())
 {
@@ -184,103 +252,273 @@ Sequence::Sequence(const Sequence& s1, const Sequence& s2,
     } else {
         // Else, start at first, end at other sequence. So flip a coin instead
         // to simulate 'reading from either end'
-        curr = RNG.rand_int(0, 2);
+        curr = rng.rand_int(0, 2);
     }
 
-    bases.assign(sequences[curr]->bases.begin(),
-                 sequences[curr]->bases.end());
-    this->mutations = sequences[curr]->mutations;
-    this->critical_mutations = sequences[curr]->critical_mutations;
-
     // Indices at which we make a template switch (the nucleotides from that
     // index onward are chosen from the 'other' sequence).
     // Cannot include 0 because that would mean we have one fewer template
     // switch. So, we sample from 1 to (n-1) (note that the sampler excludes the
     // upper bound).
-    std::set<size_type> posns_of_recomb =
-        RNG.sample_without_replacement(1, n, num_template_switches);
-    // If there are an odd number, add the last position as a place of
-    // recombination too (this means we can just read from the other
-    // sequence between consecutive values of posns_of_recomb).
-    if (num_template_switches % 2 != 0) { posns_of_recomb.insert(n); }
-
-    for (auto it = posns_of_recomb.begin();
-         it != posns_of_recomb.end(); it = std::next(it, 2))
-    {
-        size_type beg = *it;
-        size_type end = *std::next(it);
+    std::vector<size_type> posns_of_recomb =
+        rng.sample_without_replacement(1, n, num_template_switches);
 
-        // copy nucleotides from the other sequence
-        for (size_type i = 2*beg; i < 2*end; ++i)
-        {
-            bases[i] = (sequences[1-curr]->bases)[i];
-        }
+    // Recombinants of sparse sequences with the same ancestor stay sparse, and
+    // only need their mutations merged. Otherwise the bases are needed too.
+    ancestor = (s1.ancestor == s2.ancestor) ? s1.ancestor : nullptr;
+    sparse = ancestor && s1.sparse && s2.sparse;
 
-        // make sure we are keeping track of the mutations from the base
-        // sequences
-        for (auto t : sequences[curr]->mutations)
-        {
-            if (Utils::is_in_range(t.first, beg, end))
-            {
-                this->mutations.erase(t.first);
-            }
-        }
-        for (auto t : sequences[curr]->critical_mutations)
-        {
-            if (Utils::is_in_range(t, beg, end))
-            {
-                this->critical_mutations.erase(t);
-            }
-        }
-        for (auto t : sequences[1-curr]->mutations)
+    PackedBases filled[2];
+    const PackedBases * parent_bases[2];
+    for (size_type k=0; k<2 && !sparse; ++k)
+    {
+        if (sequences[k]->sparse)
         {
-            if (Utils::is_in_range(t.first, beg, end))
-            {
-                this->mutations[t.first] = t.second;
-            }
+            filled[k] = sequences[k]->dense_bases();
+            parent_bases[k] = &filled[k];
         }
-        for (auto t : sequences[1-curr]->critical_mutations)
+        else
         {
-            if (Utils::is_in_range(t, beg, end))
-            {
-                this->critical_mutations.insert(t);
-            }
+            parent_bases[k] = &sequences[k]->bases;
         }
     }
-    this->active_status = activity_tracker.check_activity(this->num_critical_mutations());
+
+    // The sequence is then made up of segments [0, p_1), [p_1, p_2), ...,
+    // [p_k, n), read alternately from the active sequence and the other one.
+    // Each segment is copied as a block of words and a block of mutations, and
+    // we only ever move forward in each parent's mutations. Chunks of bases
+    // that lie within a segment are shared with the parent.
+    if (!sparse) { bases = *parent_bases[curr]; }
+    mutations.clear();
+    mutations.reserve(std::max(s1.mutations.size(), s2.mutations.size()));
+    num_critical = 0;
+    num_changes = 0;
+
+    mutations_type::const_iterator cursors[] = {
+        sequences[0]->mutations.begin(), sequences[1]->mutations.begin() };
+
+    size_type beg = 0;
+    size_type from = curr;
+    for (auto it = posns_of_recomb.begin(); ; ++it)
+    {
+        size_type end = (it == posns_of_recomb.end()) ? n : *it;
+
+        if (from != curr && !sparse) { bases.splice(*parent_bases[from], beg, end); }
+        cursors[from] = append_mutations(sequences[from]->mutations,
+                                         cursors[from], beg, end);
+
+        if (it == posns_of_recomb.end()) { break; }
+        beg = end;
+        from = 1 - from;
+    }
+    this->active_status = activity_tracker.check_activity(this->num_critical_mutations(), rng);
+    densify_if_diverged();
+}
+
+Sequence::mutations_type::const_iterator
+Sequence::lower_bound(mutations_type::const_iterator first,
+                      mutations_type::const_iterator last, size_type n)
+{
+    return std::lower_bound(first, last, n,
+        [](const Mutation& a, size_type pos) { return a.position < pos; });
+}
+
+Sequence::mutations_type::const_iterator
+Sequence::append_mutations(const mutations_type& other,
+                           mutations_type::const_iterator first,
+                           size_type beg, size_type end)
+{
+    first = lower_bound(first, other.end(), beg);
+    auto last = lower_bound(first, other.end(), end);
+    for (auto it = first; it != last; ++it)
+    {
+        num_critical += it->critical;
+    }
+    mutations.insert(mutations.end(), first, last);
+    return last;
 }
 
-bool Sequence::point_mutate(size_type n, char new_nucleotide)
+bool Sequence::point_mutate(size_type n, char new_nucleotide, RandMaths& rng)
 {
+    auto it = mutations.begin() +
+        (lower_bound(mutations.begin(), mutations.end(), n) - mutations.cbegin());
+    bool present = (it != mutations.end() && it->position == n);
+    char old_nucleotide = present ? it->current :
+        Consts::NUC_INT2CHAR((sparse ? *ancestor : bases).base_at(n));
+
     // only if there is something new to do
-    if (char_at(n) != new_nucleotide)
+    if (old_nucleotide != new_nucleotide)
     {
-        auto it = mutations.find(n);
-        if (it == mutations.end())
+        ++num_changes;
+        if (!present)
         {
             // if this position has never been changed before, it is a
             // new mutation, so store the original nucleotide
-            mutations[n] = char_at(n);
-            if (activity_tracker.is_critical(n))
+            bool critical = activity_tracker.is_critical(n);
+            mutations.insert(it, Mutation {
+                static_cast<std::uint32_t>(n), old_nucleotide, new_nucleotide,
+                critical });
+            present = true;
+            if (critical)
             {
-                critical_mutations.insert(n);
-                active_status = activity_tracker.check_activity(this->num_critical_mutations());
+                ++num_critical;
+                active_status = activity_tracker.check_activity(this->num_critical_mutations(), rng);
             }
         }
-        else if (it->second == new_nucleotide)
+        else if (it->original == new_nucleotide)
         {
             // if new_nucleotide is the same as the original, the
             // mutation has been reversed
+            num_critical -= it->critical;
             mutations.erase(it);
-            critical_mutations.erase(n);
+            present = false;
+        }
+        else
+        {
+            it->current = new_nucleotide;
         }
         // change the actual sequence
-        auto new_bits = Consts::NUC_CHAR2BOOL(new_nucleotide);
-        bases[2*n] = new_bits.first;
-        bases[2*n+1] = new_bits.second;
+        if (sparse) { densify_if_diverged(); }
+        else { bases.set_base(n, Consts::NUC_CHAR2INT(new_nucleotide)); }
+    }
+    return present;
+}
+
+const word_type* Sequence::chunk_words(size_type c,
+                                       mutations_type::const_iterator& cursor,
+                                       word_type* scratch) const
+{
+    if (!sparse) { return bases.chunk_words(c); }
 
-        // if there is a critical mutation, store its position
+    const word_type* words = ancestor->chunk_words(c);
+    size_type chunk_end = (c+1) * PackedBases::CHUNK_NUCS;
+    if (cursor == mutations.end() || cursor->position >= chunk_end)
+    {
+        return words;
     }
-    return (mutations.find(n) != mutations.end());
+    std::copy(words, words + PackedBases::CHUNK_WORDS, scratch);
+    for (; cursor != mutations.end() && cursor->position < chunk_end; ++cursor)
+    {
+        size_type n = cursor->position % PackedBases::CHUNK_NUCS;
+        unsigned shift = Consts::NUC_BITS * (n % Consts::NUC_PER_WORD);
+        word_type& word = scratch[n / Consts::NUC_PER_WORD];
+        word = (word & ~(Consts::NUC_MASK << shift)) |
+               (word_type(Consts::NUC_CHAR2INT(cursor->current)) << shift);
+    }
+    return scratch;
 }
 
+size_type Sequence::distance_to(const Sequence& other, size_type max_d) const
+{
+    if (get_length() != other.get_length()) {
+        throw Exception("Cannot compare sequences of different lengths.");
+    }
+
+    size_type differences = 0;
+    if (sparse && other.sparse && ancestor == other.ancestor)
+    {
+        // Every mutation differs from the ancestor, so positions mutated in
+        // only one sequence are mismatches, and positions mutated in both are
+        // mismatches if they were mutated differently.
+        auto it = mutations.begin();
+        auto jt = other.mutations.begin();
+        while (it != mutations.end() && jt != other.mutations.end() &&
+               differences <= max_d)
+        {
+            if (it->position < jt->position) { ++differences; ++it; }
+            else if (jt->position < it->position) { ++differences; ++jt; }
+            else { differences += (it->current != jt->current); ++it; ++jt; }
+        }
+        return differences + (mutations.end() - it) + (other.mutations.end() - jt);
+    }
+
+    word_type scratch[2][PackedBases::CHUNK_WORDS];
+    auto it = mutations.begin();
+    auto jt = other.mutations.begin();
+    for (size_type c=0; c<PackedBases::num_chunks_for(get_length()) &&
+                        differences<=max_d; ++c)
+    {
+        const word_type* ours = chunk_words(c, it, scratch[0]);
+        const word_type* theirs = other.chunk_words(c, jt, scratch[1]);
+        // chunks shared through the ancestor or copy-on-write are identical
+        if (ours == theirs) { continue; }
+        differences += Hamming::distance(ours, theirs, PackedBases::CHUNK_WORDS);
+    }
+    return differences;
+}
+
+std::vector<size_type> Sequence::differing_positions(const Sequence& other) const
+{
+    if (get_length() != other.get_length()) {
+        throw Exception("Cannot compare sequences of different lengths.");
+    }
+
+    std::vector<size_type> positions;
+    if (sparse && other.sparse && ancestor == other.ancestor)
+    {
+        // As for distance_to(), merge the lists of mutations
+        auto it = mutations.begin();
+        auto jt = other.mutations.begin();
+        while (it != mutations.end() || jt != other.mutations.end())
+        {
+            if (jt == other.mutations.end() ||
+                (it != mutations.end() && it->position < jt->position))
+            {
+                positions.push_back(it->position); ++it;
+            }
+            else if (it == mutations.end() || jt->position < it->position)
+            {
+                positions.push_back(jt->position); ++jt;
+            }
+            else
+            {
+                if (it->current != jt->current) { positions.push_back(it->position); }
+                ++it; ++jt;
+            }
+        }
+        return positions;
+    }
+
+    word_type scratch[2][PackedBases::CHUNK_WORDS];
+    auto it = mutations.begin();
+    auto jt = other.mutations.begin();
+    for (size_type c=0; c<PackedBases::num_chunks_for(get_length()); ++c)
+    {
+        const word_type* ours = chunk_words(c, it, scratch[0]);
+        const word_type* theirs = other.chunk_words(c, jt, scratch[1]);
+        if (ours == theirs) { continue; }
+        for (size_type w=0; w<PackedBases::CHUNK_WORDS; ++w)
+        {
+            // one set bit (the lower one) for every mismatching nucleotide
+            word_type x = ours[w] ^ theirs[w];
+            x = (x | (x >> 1)) & Consts::NUC_LOW_BITS;
+            for (; x != 0; x &= x - 1)
+            {
+                positions.push_back(c * PackedBases::CHUNK_NUCS +
+                                    w * Consts::NUC_PER_WORD +
+                                    __builtin_ctzll(x) / Consts::NUC_BITS);
+            }
+        }
+    }
+    return positions;
+}
+
+size_type Sequence::distance_to(const PackedBases& other, size_type max_d) const
+{
+    if (get_length() != other.get_length()) {
+        throw Exception("Cannot compare sequences of different lengths.");
+    }
+    if (!sparse) { return bounded_distance(bases, other, max_d); }
+
+    size_type differences = 0;
+    word_type scratch[PackedBases::CHUNK_WORDS];
+    auto it = mutations.begin();
+    for (size_type c=0; c<other.num_chunks() && differences<=max_d; ++c)
+    {
+        const word_type* ours = chunk_words(c, it, scratch);
+        const word_type* theirs = other.chunk_words(c);
+        if (ours == theirs) { continue; }
+        differences += Hamming::distance(ours, theirs, PackedBases::CHUNK_WORDS);
+    }
+    return differences;
+}
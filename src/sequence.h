@@ -8,10 +8,12 @@
 
 #include "constants.h"
 #include "activity_tracker.h"
+#include "packed_bases.h"
+#include "rand_maths.h"
 
+#include <cstdint>
+#include <memory>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -26,20 +28,33 @@ namespace retrocombinator
         const tag_type SEQUENCE_INITIALISED_EXTERNALLY_TAG = -1;
         //@}
 
+        /** Sequences that differ from their initial sequence at fewer than
+         *  this fraction of positions are stored sparsely, as a list of
+         *  mutations on top of the shared initial sequence.
+         *  Past this, merging mutation lists to compute a distance costs about
+         *  as much as comparing every packed word, so the sequence is stored
+         *  densely instead.
+         */
+        const double SPARSE_DIVERGENCE_DEFAULT = 1.0/32;
+
     }
 
     /** To represent a DNA sequence and the mutations that it has
      *  undergone.
      *
      *  Keeps track of the actual sequence, mutations and critical mutations.
+     *
+     *  A sequence is stored in one of two ways. Sparse sequences only hold
+     *  their mutations, and read every other nucleotide from the initial
+     *  sequence they descend from (their ancestor), which is stored once and
+     *  shared. Dense sequences hold all of their nucleotides as well. A sparse
+     *  sequence becomes dense once it has diverged from its ancestor by more
+     *  than the threshold set with set_sparse_divergence().
      */
     class Sequence
     {
     private:
 
-        /// For the raw sequence
-        typedef std::vector<bool> raw_sequence_type;
-
         /** An internal counter that is incremented every time a sequence is
          *  created.
          *  Used to assign each sequence a unique tag.
@@ -50,6 +65,11 @@ namespace retrocombinator
          */
         static ActivityTracker activity_tracker;
 
+        /** Sparse sequences with at least this fraction of positions mutated
+         *  are made dense.
+         */
+        static double sparse_divergence;
+
         /** A number that uniquely identifies this sequence.
          *  This tag transcends activity (if an inactive sequence becomes active
          *  again, it has the same tag)
@@ -64,40 +84,107 @@ namespace retrocombinator
          */
         const std::pair<tag_type, tag_type> parent_tags;
 
-        /** Actual sequence of nucleotides.
-         *  Stored as a string internally.
+        /** The initial sequence that this sequence descends from.
+         *  Shared by all copies of an initial sequence and their recombinants,
+         *  and null for recombinants of sequences with different ancestors.
          */
-        raw_sequence_type bases;
+        std::shared_ptr<const PackedBases> ancestor;
 
-        ///@{
-        /** Basic typedefs - hashed data structures for quick lookup.
-         *  For keeping track of mutations and critical mutations.
+        /** Whether only the mutations on top of the ancestor are stored, and
+         *  \p bases is empty.
          */
-        typedef std::unordered_map<size_type, char> mutations_type;
-        typedef std::unordered_set<size_type> critical_mutations_type;
-        ///@}
+        bool sparse;
+
+        /** Actual sequence of nucleotides, if this sequence is dense.
+         *  Stored as packed words internally, in chunks that are shared with
+         *  the sequences this was copied or recombined from until mutated.
+         */
+        PackedBases bases;
+
+        /** A mutation at a position, along with what the *original*
+         *  nucleotide there was, what it is now, and whether the position is
+         *  critical.
+         *  Kept small (8 bytes) as a sequence can hold thousands of these.
+         */
+        struct Mutation
+        {
+            /// Where the mutation is
+            std::uint32_t position;
+            /// What the nucleotide was before it was mutated
+            char original;
+            /// What the nucleotide is now
+            char current;
+            /// Whether the position is in the critical region
+            bool critical;
+        };
+
+        /** For keeping track of mutations and critical mutations.
+         *  A flat list of mutations, always sorted by position, so that
+         *  ranges of positions are contiguous.
+         */
+        typedef std::vector<Mutation> mutations_type;
 
         /** Positions of mutations and what the *original* nucleotide was.
-         *  Stored as an unordered map locally.
+         *  Stored as a list sorted by position.
          */
         mutations_type mutations;
 
-        /** Positions of mutations that are critical.
-         *  Internally stored as a set. This set is always a subset of
-         *  \p mutations.keys.
+        /** How many of \p mutations are critical.
+         */
+        size_type num_critical;
+
+        /** How many point mutations have changed this sequence since it was
+         *  created.
          */
-        critical_mutations_type critical_mutations;
+        size_type num_changes;
+
+        /** Returns the first mutation in [\a first, \a last) at a position
+         *  that is >= \a n.
+         */
+        static mutations_type::const_iterator
+        lower_bound(mutations_type::const_iterator first,
+                    mutations_type::const_iterator last, size_type n);
+
+        /** Appends the mutations of \a other that lie in positions [\a beg,
+         *  \a end), searching from \a first onwards.
+         *  Returns where the search for the next (later) range can start from.
+         */
+        mutations_type::const_iterator
+        append_mutations(const mutations_type& other,
+                         mutations_type::const_iterator first,
+                         size_type beg, size_type end);
 
         /** Whether or not this sequence is capable of transposition.
           */
         bool active_status;
 
-        /** Returns the 2bit encoding for a base at a given position.
+        /** Makes this sequence dense if it has diverged too far from its
+         *  ancestor.
          */
-        inline std::pair<bool, bool> bits_at(size_type n) const
-        {
-            return std::make_pair(bases[2*n], bases[2*n+1]);
-        }
+        void densify_if_diverged();
+
+        /** Returns the words in chunk \a c of this sequence.
+         *  For sparse sequences, this is the ancestor's chunk, or if there are
+         *  mutations in it, a copy in \a scratch with the mutations applied.
+         *  \a cursor must point to the first mutation in or after the chunk,
+         *  and is moved past it.
+         */
+        const word_type* chunk_words(size_type c,
+                                     mutations_type::const_iterator& cursor,
+                                     word_type* scratch) const;
+
+        /** Number of mismatches between this sequence and \a other.
+         *  Stops once more than \a max_d mismatches have been seen, and then
+         *  returns some value greater than \a max_d.
+         *  Two sparse sequences with the same ancestor are compared by merging
+         *  their lists of mutations, everything else chunk by chunk.
+         */
+        size_type distance_to(const Sequence& other, size_type max_d) const;
+
+        /** Number of mismatches between this sequence and \a other, as for
+         *  distance_to(const Sequence&, size_type).
+         */
+        size_type distance_to(const PackedBases& other, size_type max_d) const;
 
     public:
         /** Explicitly update the global sequence count to start from a
@@ -111,16 +198,31 @@ namespace retrocombinator
           */
         static void set_activity_tracker(ActivityTracker activity_tracker_);
 
-        /** Constructs a random sequence.
+        /** Set the fraction of mutated positions at which a sparse sequence
+         *  is made dense (by default, Consts::SPARSE_DIVERGENCE_DEFAULT).
+         *  0 keeps every sequence dense.
+         */
+        static void set_sparse_divergence(double sparse_divergence_);
+
+        /** Constructs a random sequence, drawn from \a rng.
          *  This is considered initial, so no mutations are present.
          */
-        Sequence();
+        explicit Sequence(RandMaths& rng);
 
         /** Constructs a sequence from a given string.
          *  This is considered initial, so no mutations are present.
          */
         Sequence(std::string s);
 
+        /** Constructs a copy of the initial sequence \a ancestor (see
+         *  get_ancestor()).
+         *  This is considered initial, so no mutations are present, and it is
+         *  tagged as if it was created from a string. The nucleotides are
+         *  shared with \a ancestor, so this is the cheap way to create many
+         *  copies of the same initial sequence.
+         */
+        explicit Sequence(std::shared_ptr<const PackedBases> ancestor);
+
         /** Constructs a sequence from recombining two other sequences.
          *
          *  The number of template switches has to be specified, and the
@@ -136,9 +238,10 @@ namespace retrocombinator
          *  is used for \a s_new at position \a l had mutation \a m present at
          *  that position.
          *
+         *  Random numbers are drawn from \a rng.
          */
         Sequence(const Sequence& s1, const Sequence& s2,
-                 size_type num_template_switches);
+                 size_type num_template_switches, RandMaths& rng);
 
         ///@{
         /** Delete copy constructors as we want tags to be unique.
@@ -155,7 +258,10 @@ namespace retrocombinator
         ///@}
 
         /// Returns length of the sequence
-        size_type get_length() const { return (bases.size()/2); }
+        size_type get_length() const
+        {
+            return sparse ? ancestor->get_length() : bases.get_length();
+        }
 
         /// Returns the unique label for this sequence
         tag_type get_tag() const { return tag; }
@@ -168,26 +274,53 @@ namespace retrocombinator
 
         /** Returns the character for a base at a given position.
          */
-        inline char char_at(size_type n) const
+        char char_at(size_type n) const
         {
-            return Consts::NUC_BOOL2CHAR(bits_at(n));
+            if (!sparse) { return Consts::NUC_INT2CHAR(bases.base_at(n)); }
+            auto it = lower_bound(mutations.begin(), mutations.end(), n);
+            return (it != mutations.end() && it->position == n) ?
+                   it->current : Consts::NUC_INT2CHAR(ancestor->base_at(n));
         }
 
+        /** Returns the positions at which this sequence and \a other differ,
+         *  in ascending order.
+         */
+        std::vector<size_type> differing_positions(const Sequence& other) const;
+
+        /** Returns the initial sequence that this sequence descends from.
+         *  Null if this is a recombinant of sequences that descend from
+         *  different initial sequences.
+         */
+        std::shared_ptr<const PackedBases> get_ancestor() const { return ancestor; }
+
+        /** Tests whether this sequence is stored as mutations on top of its
+         *  ancestor.
+         */
+        bool is_sparse() const { return sparse; }
+
         /** Changes the nucleotide at position \a n to \a new_nucleotide.
          *
          *  If the new_nucleotide is the same as the original nucleotide in the
          *  string, the mutation disappears, else a mutation is created.
          *  The activity tracker is used to determined whether or not a mutation
-         *  is critical.
+         *  is critical, and whether a critical one makes the sequence inactive
+         *  (with random numbers drawn from \a rng).
          *
          *  Returns true iff there is a mutation present at the end.
          */
-        bool point_mutate(size_type n, char new_nucleotide);
+        bool point_mutate(size_type n, char new_nucleotide, RandMaths& rng);
 
         /** Returns the raw nucleotide sequence as a string.
          */
         std::string as_string() const;
 
+        /** Returns the nucleotides of this sequence, filled in from the
+         *  ancestor if this sequence is sparse.
+         *  The chunks are shared with this sequence (or its ancestor) until
+         *  either is mutated, so this is cheap to keep.
+         */
+        PackedBases dense_bases() const;
+
         /** Tests whether this sequence is active (can transpose) or not.
          */
         bool is_active() const { return active_status; }
@@ -198,7 +331,14 @@ namespace retrocombinator
 
         /** Returns how many critical region mutations are present in this sequence.
          */
-        size_type num_critical_mutations() const { return critical_mutations.size(); }
+        size_type num_critical_mutations() const { return num_critical; }
+
+        /** Returns how many point mutations have changed this sequence since
+         *  it was created (including ones that were later reversed).
+         *  As tags are unique, a sequence with the same tag and count as
+         *  before has not changed in between.
+         */
+        size_type get_num_changes() const { return num_changes; }
 
         /** Returns sequence similarity to initial sequence.
          */
@@ -218,7 +358,50 @@ namespace retrocombinator
          *  mismatches (because insertions and deletions are not possible in
          *  this system).
           */
-        friend size_type operator *(const Sequence& s1, std::string s2);
+        friend size_type operator *(const Sequence& s1, const std::string& s2);
+        /** Pairwise distances between a sequence and packed nucleotides, as
+         *  for operator*(const Sequence&, const std::string&).
+          */
+        friend size_type operator *(const Sequence& s1, const PackedBases& s2);
+
+        /** Pairwise distance between two sequences, if it is at most \a
+         *  max_d.
+         *  Stops comparing once more than \a max_d mismatches have been seen,
+         *  and then returns some value that is greater than \a max_d.
+          */
+        friend size_type bounded_distance(const Sequence& s1, const Sequence& s2,
+                                          size_type max_d);
+        /** Pairwise distance between a sequence and a string, if it is at
+         *  most \a max_d, as for bounded_distance(const Sequence&, const
+         *  Sequence&, size_type).
+          */
+        friend size_type bounded_distance(const Sequence& s1, const std::string& s2,
+                                          size_type max_d);
+        /** Pairwise distance between a sequence and packed nucleotides, if it
+         *  is at most \a max_d, as for bounded_distance(const Sequence&, const
+         *  Sequence&, size_type).
+          */
+        friend size_type bounded_distance(const Sequence& s1, const PackedBases& s2,
+                                          size_type max_d);
+        /** Tests whether two sequences are at most \a max_d apart.
+         *  Equivalent to <tt>s1 * s2 <= max_d</tt>, but stops early when they
+         *  are not.
+          */
+        friend bool within_distance(const Sequence& s1, const Sequence& s2,
+                                    size_type max_d);
+        /** Tests whether a sequence and a string are at most \a max_d apart.
+         *  Equivalent to <tt>s1 * s2 <= max_d</tt>, but stops early when they
+         *  are not.
+          */
+        friend bool within_distance(const Sequence& s1, const std::string& s2,
+                                    size_type max_d);
+        /** Tests whether a sequence and packed nucleotides are at most \a
+         *  max_d apart.
+         *  Equivalent to <tt>s1 * s2 <= max_d</tt>, but stops early when they
+         *  are not.
+          */
+        friend bool within_distance(const Sequence& s1, const PackedBases& s2,
+                                    size_type max_d);
 
         /** Pairwise dissimilarity between two sequences.
          *  Similarity is 1-dissimilarity.
@@ -227,7 +410,7 @@ namespace retrocombinator
         /** Pairwise dissimilarity between a sequence and a string.
          *  Similarity is 1-dissimilarity.
           */
-        friend double operator %(const Sequence& s1, std::string s2);
+        friend double operator %(const Sequence& s1, const std::string& s2);
     };
 
     /// A list of sequences
@@ -238,12 +421,12 @@ namespace retrocombinator
      *  mismatches (because insertions and deletions are not possible in
      *  this system).
       */
-    size_type operator *(std::string s1, std::string s2);
+    size_type operator *(const std::string& s1, const std::string& s2);
 
     /** Pairwise dissimilarity between two strings.
       *  Similarity is 1-dissimilarity.
       */
-    double operator %(std::string s1, std::string s2);
+    double operator %(const std::string& s1, const std::string& s2);
 }
 
 #endif //SEQUENCE_H
@@ -11,7 +11,9 @@ Simulation::Simulation(
     double recomb_mean, double recomb_similarity,
     double selection_threshold,
     double family_coherence, size_type max_num_representatives,
-    size_type num_steps, double time_per_step,
+    size_type family_threads,
+    size_type family_update_cadence, double family_update_change,
+    size_type num_steps, double time_per_step, bool track_distances,
     std::string filename_out,
     size_type num_init_dist, size_type num_pair_dist,
     size_type num_fam_size, size_type num_fam_dist,
@@ -24,12 +26,15 @@ Simulation::Simulation(
          burst_probability, burst_mean, max_total_copies,
          recomb_mean, recomb_similarity,
          selection_threshold),
-    families((1.0-family_coherence)*sequence_length, max_num_representatives),
+    families((1.0-family_coherence)*sequence_length, max_num_representatives,
+             family_threads),
     num_steps(num_steps), time_per_step(time_per_step),
     output(filename_out, num_steps,
            num_init_dist, num_pair_dist, num_fam_size, num_fam_dist,
            floor((1.0-min_output_similarity)*sequence_length))
 {
+    families.set_update_schedule(family_update_cadence, family_update_change);
+    pool.set_track_distances(track_distances);
     output.print_params(sequence, sequence_length, num_initial_copies,
         critical_region_length, inactive_probability,
         mutation_model,
@@ -37,7 +42,9 @@ Simulation::Simulation(
         recomb_mean, recomb_similarity,
         selection_threshold,
         family_coherence, max_num_representatives,
-        num_steps, time_per_step,
+        family_threads,
+        family_update_cadence, family_update_change,
+        num_steps, time_per_step, track_distances,
         filename_out,
         num_init_dist, num_pair_dist,
         num_fam_size, num_fam_dist,
@@ -50,7 +57,12 @@ void Simulation::simulate() {
     // timestep 0 is initial case
     for(size_type timestep = 1; timestep <= num_steps; ++timestep) {
         pool.step(time_per_step);
-        families.update(pool, timestep);
+        // families are output from their last update, so update them when
+        // they are output, and in between only as often as scheduled
+        if (output.prints_families(timestep) ||
+            families.update_due(pool, timestep)) {
+            families.update(pool, timestep);
+        }
         output.output(timestep, pool, families);
     }
 }
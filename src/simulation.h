@@ -34,8 +34,18 @@ namespace retrocombinator
           * \param family_coherence The minimum similarity needed between
           * clusters for them to form the same family
           * \param max_num_representatives \copydoc Families::max_num_representatives
+          * \param family_threads \copydoc Families::num_threads
+          * \param family_update_cadence \copydoc Families::update_cadence
+          * \param family_update_change \copydoc Families::update_change_fraction
+          * (families are always updated on the steps they are output, see
+          * Families::set_update_schedule)
           * \param num_steps \copydoc Simulation::num_steps
           * \param time_per_step \copydoc Simulation::time_per_step
+          * \param track_distances Should the distances between every two
+          * sequences be kept up to date as the pool changes (see
+          * Pool::set_track_distances)? This does not change the results,
+          * and is faster when pairwise distances are output often, at the
+          * cost of memory quadratic in the size of the pool.
           * \param filename_out What file to save output to?
           * \param num_init_dist How many times should we print out distances to
           * the initial sequence?
@@ -57,7 +67,9 @@ namespace retrocombinator
             double recomb_mean, double recomb_similarity,
             double selection_threshold,
             double family_coherence, size_type max_num_representatives,
-            size_type num_steps, double time_per_step,
+            size_type family_threads,
+            size_type family_update_cadence, double family_update_change,
+            size_type num_steps, double time_per_step, bool track_distances,
             std::string filename_out,
             size_type num_init_dist, size_type num_pair_dist,
             size_type num_fam_size, size_type num_fam_dist,
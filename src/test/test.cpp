@@ -1,13 +1,23 @@
 #include <iostream>
 
+#include "test_philox.h"
 #include "test_rand_maths.h"
+#include "test_alias_table.h"
+#include "test_weighted_sampler.h"
 #include "test_activity_tracker.h"
+#include "test_hamming.h"
+#include "test_packed_bases.h"
 #include "test_sequence.h"
 #include "test_point_mutation_models.h"
 #include "test_mutator.h"
+#include "test_distance_matrix.h"
 #include "test_pool.h"
+#include "test_families.h"
 #include "test_simulation.h"
 #include "test_utilities.h"
+#include "test_condensed_matrix.h"
+#include "test_union_find.h"
+#include "test_bk_tree.h"
 
 using namespace std;
 using namespace retrocombinator;
@@ -16,15 +26,39 @@ int main()
 {
     cout << "Testing Modules (0 is success)" << endl;
 
+    cout << "Testing Philox: " << endl;
+    cout << test_philox() << endl;
+
     cout << "Testing Rand Maths: " << endl;
     cout << test_rand_maths() << endl;
 
+    cout << "Testing Alias Table: " << endl;
+    cout << test_alias_table() << endl;
+
+    cout << "Testing Weighted Sampler: " << endl;
+    cout << test_weighted_sampler() << endl;
+
     cout << "Testing Utilities: " << endl;
     cout << test_utilities() << endl;
 
+    cout << "Testing Condensed Matrix: " << endl;
+    cout << test_condensed_matrix() << endl;
+
+    cout << "Testing Union Find: " << endl;
+    cout << test_union_find() << endl;
+
+    cout << "Testing BK Tree: " << endl;
+    cout << test_bk_tree() << endl;
+
     cout << "Testing Activity Tracker: " << endl;
     cout << test_activity_tracker() << endl;
 
+    cout << "Testing Hamming: " << endl;
+    cout << test_hamming() << endl;
+
+    cout << "Testing Packed Bases: " << endl;
+    cout << test_packed_bases() << endl;
+
     cout << "Testing Sequence: " << endl;
     cout << test_sequence() << endl;
 
@@ -34,11 +68,17 @@ int main()
     cout << "Testing Mutator: " << endl;
     cout << test_mutator() << endl;
 
+    cout << "Testing Distance Matrix: " << endl;
+    cout << test_distance_matrix() << endl;
+
     cout << "Testing Pool (& Burster): " << endl;
     cout << test_pool() << endl;
 
     cout << "Testing Simulation: " << endl;
     cout << test_simulation() << endl;
 
+    cout << "Testing Families: " << endl;
+    cout << test_families() << endl;
+
     return 0;
 }
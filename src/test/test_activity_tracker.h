@@ -35,23 +35,25 @@ namespace retrocombinator
             assert (at.is_critical(8) == true);
             assert (at.is_critical(9) == true);
 
-            assert (at.check_activity(0) == true);
-            assert (at.check_activity(1) == false);
-            assert (at.check_activity(2) == false);
+            assert (at.check_activity(0, RNG) == true);
+            assert (at.check_activity(1, RNG) == false);
+            assert (at.check_activity(2, RNG) == false);
 
             ActivityTracker at_hi(10, 2, 0.9);
-            assert (at_hi.check_activity(1) == false);
-            assert (at_hi.check_activity(2) == false);
+            assert (at_hi.check_activity(1, RNG) == false);
+            assert (at_hi.check_activity(2, RNG) == false);
 
             ActivityTracker at_low(1000, 2, 0.01);
-            assert (at_low.check_activity(1) == true);
-            assert (at_low.check_activity(2) == true);
-            assert (at_low.check_activity(5) == true);
-            assert (at_low.check_activity(999) == false);
+            assert (at_low.check_activity(1, RNG) == true);
+            assert (at_low.check_activity(2, RNG) == true);
+            assert (at_low.check_activity(5, RNG) == true);
+            assert (at_low.check_activity(999, RNG) == false);
 
             ActivityTracker at_mid(10, 2, 0.4);
-            assert (at_mid.check_activity(1) == true);
-            assert (at_mid.check_activity(2) == false);
+            assert (at_mid.check_activity(1, RNG) == false);
+            assert (at_mid.check_activity(2, RNG) == false);
+            assert (at_mid.check_activity(1, RNG) == true);
+            assert (at_mid.check_activity(2, RNG) == true);
 
             return 0;
         }
@@ -0,0 +1,61 @@
+/**
+ * @file
+ *
+ * \brief To test the functionality of the AliasTable class.
+ *
+ */
+#ifndef TEST_ALIAS_TABLE_H
+#define TEST_ALIAS_TABLE_H
+
+#include "test_header.h"
+#include "../alias_table.h"
+
+#include <cmath>
+
+namespace retrocombinator
+{
+    /// Tests AliasTable
+    int test_alias_table()
+    {
+        test_initialize();
+
+        try {
+            // Events with no probability are never picked
+            double weights_1[] = {0.0, 1.0, 0.0};
+            AliasTable table_1(weights_1, 3);
+            assert (table_1.size() == 3);
+            assert (table_1.sample(0.0) == 1);
+            assert (table_1.sample(0.5) == 1);
+            assert (table_1.sample(0.99) == 1);
+
+            // Every event is picked as often as its (relative) probability
+            double weights_2[] = {0.0, 1.0, 2.0, 5.0, 0.5, 1.5};
+            AliasTable table_2(weights_2, 6);
+            size_type counts[6] = {0, 0, 0, 0, 0, 0};
+            size_type num_samples = 100000;
+            for (size_type i=0; i<num_samples; ++i)
+            {
+                counts[table_2.sample(RNG.rand_real())] += 1;
+            }
+            for (size_type j=0; j<6; ++j)
+            {
+                assert (fabs(double(counts[j])/num_samples - weights_2[j]/10.0) < 0.01);
+            }
+
+            // Probabilities must make sense
+            bool thrown = false;
+            double weights_3[] = {0.0, 0.0};
+            try { AliasTable table_3(weights_3, 2); }
+            catch (Exception e) { thrown = true; }
+            assert (thrown);
+
+            return 0;
+        }
+        catch (Exception e)
+        {
+            std::cout << e.what() << std::endl;
+            return 1;
+        }
+    }
+}
+#endif // TEST_ALIAS_TABLE_H
@@ -0,0 +1,90 @@
+/**
+ * @file
+ *
+ * \brief To test the functionality of the BKTree class.
+ *
+ */
+#ifndef TEST_BK_TREE_H
+#define TEST_BK_TREE_H
+
+#include "test_header.h"
+#include "../bk_tree.h"
+#include "../sequence.h"
+
+namespace retrocombinator
+{
+    /// Tests BKTree
+    int test_bk_tree()
+    {
+        test_initialize();
+
+        try {
+            // Items are numbers, the distance between them is their difference
+            std::vector<size_type> numbers { 10, 3, 17, 12, 40, 11 };
+            auto from = [&numbers](size_type x) {
+                return [&numbers, x](size_type k, size_type) {
+                    return numbers[k] > x ? numbers[k] - x : x - numbers[k];
+                };
+            };
+            BKTree tree;
+            assert (!tree.any_within(100, from(0)));
+            for (size_type k = 0; k < numbers.size(); ++k) {
+                tree.insert(k, from(numbers[k]));
+            }
+            assert (tree.size() == 6);
+            assert (tree.any_within(1, from(13)) && !tree.any_within(4, from(25)));
+            assert ((tree.all_within(2, from(11)) ==
+                     std::vector<size_type> { 0, 3, 5 }));
+            assert ((tree.all_within(0, from(40)) == std::vector<size_type> { 4 }));
+
+            // Items are sequences, and the answers match those of a linear
+            // scan, also when the distances stop early
+            ActivityTracker at(40, 2, 0.0);
+            Sequence::set_activity_tracker(at);
+            std::vector<std::string> strings;
+            for (size_type k = 0; k < 200; ++k) {
+                std::string s(40, 'A');
+                for (size_type i = 0; i < 40; ++i) {
+                    if (RNG.rand_real() < 0.15) {
+                        s[i] = Consts::NUC_INT2CHAR(RNG.rand_int(0, 4));
+                    }
+                }
+                strings.push_back(s);
+            }
+            BKTree strings_tree;
+            for (size_type k = 0; k < strings.size(); ++k) {
+                strings_tree.insert(k, [&strings, k](size_type j, size_type) {
+                    return strings[j] * strings[k];
+                });
+            }
+            for (size_type trial = 0; trial < 50; ++trial) {
+                Sequence query(std::string(40, 'A'));
+                for (size_type i = 0; i < 40; ++i) {
+                    if (RNG.rand_real() < 0.15) {
+                        query.point_mutate(i, Consts::NUC_INT2CHAR(RNG.rand_int(0, 4)), RNG);
+                    }
+                }
+                auto dist = [&strings, &query](size_type k, size_type bound) {
+                    return bounded_distance(query, strings[k], bound);
+                };
+                for (size_type max_d : {0, 2, 5, 9}) {
+                    std::vector<size_type> expected;
+                    for (size_type k = 0; k < strings.size(); ++k) {
+                        if (query * strings[k] <= max_d) { expected.push_back(k); }
+                    }
+                    assert (strings_tree.all_within(max_d, dist) == expected);
+                    assert (strings_tree.any_within(max_d, dist) == !expected.empty());
+                }
+            }
+
+            return 0;
+        }
+        catch (Exception e)
+        {
+            std::cout << e.what() << std::endl;
+            return 1;
+        }
+    }
+}
+
+#endif // TEST_BK_TREE_H
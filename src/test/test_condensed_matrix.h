@@ -0,0 +1,65 @@
+/**
+ * @file
+ *
+ * \brief To test the functionality of the CondensedMatrix class.
+ *
+ */
+#ifndef TEST_CONDENSED_MATRIX_H
+#define TEST_CONDENSED_MATRIX_H
+
+#include "test_header.h"
+#include "../condensed_matrix.h"
+
+namespace retrocombinator
+{
+    /// Tests CondensedMatrix
+    int test_condensed_matrix()
+    {
+        test_initialize();
+
+        try {
+            // Cells are 16 bits wide unless distances can be larger
+            CondensedMatrix narrow(4, 65535);
+            CondensedMatrix wide(4, 65536);
+            assert (!narrow.is_wide() && wide.is_wide());
+
+            // The matrix is symmetric, with 0 on the diagonal
+            narrow.set(0, 3, 65535);
+            narrow.set(2, 1, 7);
+            wide.set(3, 0, 100000);
+            assert (narrow.get(3, 0) == 65535 && narrow.get(1, 2) == 7);
+            assert (narrow.get(2, 2) == 0 && narrow.get(0, 1) == 0);
+            assert (wide.get(0, 3) == 100000);
+
+            // Growing keeps the distances, and new ones are 0
+            narrow.resize(6);
+            assert (narrow.size() == 6);
+            assert (narrow.get(0, 3) == 65535 && narrow.get(1, 2) == 7);
+            assert (narrow.get(5, 0) == 0);
+            narrow.set(5, 4, 3);
+            assert (narrow.get(4, 5) == 3 && narrow.get(0, 3) == 65535);
+
+            // Copying from a full matrix
+            dist_type full = {
+                dist_row_type { 0, 1, 2 },
+                dist_row_type { 1, 0, 70000 },
+                dist_row_type { 2, 70000, 0 }
+            };
+            CondensedMatrix copied(full);
+            assert (copied.is_wide() && copied.size() == 3);
+            for (size_type i = 0; i < 3; ++i) {
+                for (size_type j = 0; j < 3; ++j) {
+                    assert (copied.get(i, j) == full[i][j]);
+                }
+            }
+
+            return 0;
+        }
+        catch (Exception e)
+        {
+            std::cout << e.what() << std::endl;
+            return 1;
+        }
+    }
+}
+#endif // TEST_CONDENSED_MATRIX_H
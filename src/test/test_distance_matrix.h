@@ -0,0 +1,131 @@
+/**
+ * @file
+ *
+ * \brief To test the functionality of the DistanceMatrix class.
+ *
+ */
+#ifndef TEST_DISTANCE_MATRIX_H
+#define TEST_DISTANCE_MATRIX_H
+
+#include "test_header.h"
+#include "../distance_matrix.h"
+#include "../pool.h"
+
+namespace retrocombinator
+{
+    /// Tests DistanceMatrix, on its own and as kept by a pool
+    int test_distance_matrix()
+    {
+        test_initialize();
+
+        try {
+            ActivityTracker at(12, 2, 1.0);
+            Sequence::renumber_sequences();
+            Sequence::set_activity_tracker(at);
+
+            // Adding, mutating and removing sequences
+            sequence_list seqs;
+            DistanceMatrix distances(12);
+            seqs.emplace_back(std::string("TTTTTTTTTTTT"));
+            distances.add(seqs.back());
+            seqs.emplace_back(std::string("TTTTAAAATTTT"));
+            distances.add(seqs.back());
+            seqs.emplace_back(seqs.front(), seqs.back(), 2, RNG);
+            distances.add_from(seqs.back(), seqs.front());
+            for (const auto& s1 : seqs) {
+                for (const auto& s2 : seqs) {
+                    assert (distances.get(s1, s2) == s1 * s2);
+                }
+            }
+
+            Sequence& second = *std::next(seqs.begin());
+            Mutator::change_list changes { {0, 'T'}, {5, 'A'} };
+            second.point_mutate(0, 'C', RNG);
+            second.point_mutate(5, 'G', RNG);
+            distances.update_mutated(second, changes);
+            assert (distances.get(second, seqs.front()) == 5);
+            assert (distances.get(seqs.back(), second) == seqs.back() * second);
+
+            // Removed sequences free their slots for new ones
+            distances.remove(seqs.front());
+            assert (distances.size() == 2 && !distances.contains(seqs.front()));
+            seqs.pop_front();
+            seqs.emplace_back(std::string("GGGGGGGGGGGG"));
+            distances.add(seqs.back());
+            assert (distances.size() == 3);
+            auto dist_mat = distances.as_matrix(seqs);
+            size_type i = 0;
+            for (const auto& s1 : seqs) {
+                size_type j = 0;
+                for (const auto& s2 : seqs) {
+                    assert (dist_mat.get(i, j) == s1 * s2);
+                    ++j;
+                }
+                ++i;
+            }
+
+            // Once most slots are free, the matrix shrinks to the sequences
+            // left, and keeps their distances
+            sequence_list many;
+            DistanceMatrix many_distances(12);
+            for (size_type k = 0; k < 100; ++k) {
+                many.emplace_back(RNG);
+                many_distances.add(many.back());
+            }
+            assert (many_distances.num_slots() == 100);
+            for (auto it = many.begin(); it != many.end(); ) {
+                if (it->get_tag() % 5 < 3) {
+                    many_distances.remove(*it);
+                    it = many.erase(it);
+                }
+                else { ++it; }
+            }
+            assert (many_distances.size() == many.size());
+            assert (many_distances.num_slots() < 100);
+            for (const auto& s1 : many) {
+                for (const auto& s2 : many) {
+                    assert (many_distances.get(s1, s2) == s1 * s2);
+                }
+            }
+            many.emplace_back(many.front(), many.back(), 2, RNG);
+            many_distances.add_from(many.back(), many.front());
+            for (const auto& s1 : many) {
+                assert (many_distances.get(s1, many.back()) == s1 * many.back());
+            }
+
+            // The pool keeps its matrix in step with its sequences, through
+            // mutation, bursts, pruning and selection
+            std::string init_seq(300, 'T');
+            Pool pool(init_seq, init_seq.length(), 10,
+                      /* ActivityTracker */ 50, 0.5,
+                      /* Mutator */ "K80",
+                      /* Burst */ 0.8, 3, 40,
+                      /* Recomb */ 3, 0.9,
+                      /* Select */ 0.9);
+            assert (!pool.tracks_distances());
+            pool.set_track_distances(true);
+            for (size_type step = 0; step < 10; ++step) {
+                pool.step(0.05);
+                dist_mat = pool.get_distances().as_matrix(pool.get_pool());
+                assert (dist_mat.size() == pool.get_pool().size());
+                i = 0;
+                for (const auto& s1 : pool.get_pool()) {
+                    size_type j = 0;
+                    for (const auto& s2 : pool.get_pool()) {
+                        assert (dist_mat.get(i, j) == s1 * s2);
+                        ++j;
+                    }
+                    ++i;
+                }
+            }
+
+            return 0;
+        }
+        catch (Exception e)
+        {
+            std::cout << e.what() << std::endl;
+            return 1;
+        }
+    }
+}
+#endif // TEST_DISTANCE_MATRIX_H
@@ -0,0 +1,146 @@
+/**
+ * @file
+ *
+ * \brief To test the functionality of the Families class.
+ */
+
+#ifndef TEST_FAMILIES_H
+#define TEST_FAMILIES_H
+
+#include "test_header.h"
+#include "../families.h"
+#include "../pool.h"
+#include <map>
+#include <set>
+#include <string>
+
+namespace retrocombinator
+{
+    /** Builds a pool of \a n copies of a sequence, tagged 1 to \a n.
+     *  Tags are renumbered for every pool, so pools of different sizes share
+     *  their first tags.
+     */
+    Pool make_families_test_pool(size_type n)
+    {
+        return Pool(std::string(20, 'A'), 20, n,
+                    /* ActivityTracker */ 5, 0.0,
+                    /* Mutator */ "JC69",
+                    /* Burst */ 0.0, 1, 2*n,
+                    /* Recomb */ 0, 0.5,
+                    /* Select */ 0.0);
+    }
+
+    /// Tests Families, when updates are due and which families it finds
+    int test_families()
+    {
+        test_initialize();
+
+        try {
+            // When updates are due, against pools that share 8 tags
+            Pool pool_8 = make_families_test_pool(8);
+            Pool pool_10 = make_families_test_pool(10);  // 2 entered
+            Pool pool_11 = make_families_test_pool(11);  // 3 entered
+            Pool pool_6 = make_families_test_pool(6);    // 2 left
+            Pool pool_5 = make_families_test_pool(5);    // 3 left
+
+            Families scheduled(3, 10, 1);
+            assert(scheduled.update_due(pool_8, 5));     // never updated
+            scheduled.update(pool_8, 5);
+            assert(!scheduled.update_due(pool_8, 100));  // no cadence by default
+
+            // more than a quarter (2 of 8) must change, by default
+            assert(!scheduled.update_due(pool_10, 6));
+            assert(scheduled.update_due(pool_11, 6));
+            assert(!scheduled.update_due(pool_6, 6));
+            assert(scheduled.update_due(pool_5, 6));
+
+            scheduled.set_update_schedule(4, 0.25);
+            assert(!scheduled.update_due(pool_8, 6));
+            assert(!scheduled.update_due(pool_8, 8));
+            assert(scheduled.update_due(pool_8, 9));
+            assert(scheduled.update_due(pool_8, 12));
+            scheduled.update(pool_8, 9);
+            assert(!scheduled.update_due(pool_8, 12));
+            assert(scheduled.update_due(pool_8, 13));
+
+            // with no change allowed, any sequence entering or leaving will do
+            scheduled.set_update_schedule(0, 0.0);
+            assert(!scheduled.update_due(pool_8, 10));
+            assert(scheduled.update_due(pool_10, 10));
+            assert(scheduled.update_due(pool_6, 10));
+
+            bool caught = false;
+            try { scheduled.set_update_schedule(1, -0.1); }
+            catch (Exception&) { caught = true; }
+            assert(caught);
+
+            // Which families sequences are in, as a pool changes
+            std::string init_seq(60, 'A');
+            Pool pool(init_seq, init_seq.length(), 30,
+                      /* ActivityTracker */ 10, 0.1,
+                      /* Mutator */ "JC69",
+                      /* Burst */ 0.5, 4, 40,
+                      /* Recomb */ 2, 0.5,
+                      /* Select */ 0.0);
+            const size_type threshold = 6;
+            Families families(threshold, 20, 2);
+            assert(families.families_of(1).empty());
+
+            std::set<tag_type> seen, removed;
+            size_type num_members = 0, num_unchanged = 0;
+            std::map<tag_type, size_type> num_changes;
+            for (size_type t = 1; t <= 30; ++t) {
+                // some steps only burst, leaving most sequences unchanged
+                pool.step(t % 2 ? 0.5 : 0.0);
+                families.update(pool, t);
+
+                // every sequence against every representative, as of the update
+                const auto& reps = families.get_representatives();
+                std::map<tag_type, std::vector<size_type>> expected;
+                for (const auto& seq : pool.get_pool()) {
+                    auto& expected_seq = expected[seq.get_tag()];
+                    PackedBases bases = seq.dense_bases();
+                    for (size_type k = 0; k < reps.size(); ++k) {
+                        if (distance(bases, reps[k].raw_sequence) < threshold) {
+                            expected_seq.push_back(k);
+                        }
+                    }
+                    num_members += expected_seq.size();
+
+                    auto before = num_changes.find(seq.get_tag());
+                    num_unchanged += before != num_changes.end() &&
+                                     before->second == seq.get_num_changes();
+                    num_changes[seq.get_tag()] = seq.get_num_changes();
+                }
+                for (auto tag : seen) {
+                    if (!expected.count(tag)) { removed.insert(tag); }
+                }
+                for (const auto& e : expected) { seen.insert(e.first); }
+
+                // membership stays as of the update, even once the pool moves on
+                if (t % 3 == 0) { pool.step(0.5); }
+
+                for (const auto& e : expected) {
+                    assert(families.families_of(e.first) == e.second);
+                }
+                for (auto tag : removed) {
+                    assert(families.families_of(tag).empty());
+                }
+                for (const auto& seq : pool.get_pool()) {
+                    if (!expected.count(seq.get_tag())) {
+                        assert(families.families_of(seq.get_tag()).empty());
+                    }
+                }
+            }
+            assert(families.get_representatives().size() > 1);
+            assert(!removed.empty() && num_members > 0 && num_unchanged > 0);
+            return 0;
+        }
+        catch (Exception e)
+        {
+            std::cout << e.what() << std::endl;
+            return 1;
+        }
+    }
+}
+#endif // TEST_FAMILIES_H
@@ -0,0 +1,73 @@
+/**
+ * @file
+ *
+ * \brief To test the kernels that count mismatches between packed sequences.
+ *
+ */
+#ifndef TEST_HAMMING_H
+#define TEST_HAMMING_H
+
+#include "test_header.h"
+#include "../hamming.h"
+
+namespace retrocombinator
+{
+    /// Tests that every available Hamming kernel agrees with a plain count
+    int test_hamming()
+    {
+        test_initialize();
+
+        try {
+            // Testing packing against a character by character comparison
+            std::string s1("TCAGTCAGTCAGTCAGTCAGTCAGTCAGTCAGTCAG");
+            std::string s2("TCAGTCAGTCAGTCAGTCAGTCAGTCAGTCAGTCAG");
+            s2[0] = 'C'; s2[31] = 'T'; s2[32] = 'A'; s2[35] = 'C';
+            auto w1 = Hamming::pack(s1);
+            auto w2 = Hamming::pack(s2);
+            assert (w1.size() == 2);
+            assert (w1[1] == 0xE4);
+            assert (Hamming::distance(w1.data(), w2.data(), w1.size()) == 4);
+
+            // Testing all kernels on random words of many lengths
+            std::vector<word_type> a(40), b(40);
+            for (size_type i = 0; i < a.size(); ++i) {
+                for (size_type k = 0; k < 64; ++k) {
+                    a[i] = (a[i] << 1) | RNG.rand_bit();
+                    b[i] = (b[i] << 1) | RNG.rand_bit();
+                }
+            }
+            // only make some of the words differ
+            b[3] = a[3]; b[17] = a[17];
+
+            std::vector<size_type> expected(a.size() + 1, 0);
+            for (size_type n = 1; n <= a.size(); ++n) {
+                size_type count = 0;
+                for (size_type k = 0; k < Consts::NUC_PER_WORD; ++k) {
+                    unsigned shift = Consts::NUC_BITS * k;
+                    if (((a[n-1] >> shift) & Consts::NUC_MASK) !=
+                        ((b[n-1] >> shift) & Consts::NUC_MASK)) {
+                        ++count;
+                    }
+                }
+                expected[n] = expected[n-1] + count;
+            }
+
+            std::string default_kernel = Hamming::get_kernel_name();
+            for (const auto& name : Hamming::get_available_kernels()) {
+                Hamming::set_kernel(name);
+                for (size_type n = 0; n <= a.size(); ++n) {
+                    assert (Hamming::distance(a.data(), b.data(), n) == expected[n]);
+                }
+            }
+            Hamming::set_kernel(default_kernel);
+
+            return 0;
+        }
+        catch (Exception e)
+        {
+            std::cout << e.what() << std::endl;
+            return 1;
+        }
+    }
+}
+#endif //TEST_HAMMING_H
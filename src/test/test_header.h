@@ -16,12 +16,14 @@
 
 namespace retrocombinator
 {
-    /** Simple utility to check if two files are identical or not.
+    /** Simple utility to check if two files are identical or not, apart from
+     *  lines that match the (basic) regular expression \a ignore, if given.
      *  Needs the command-line utility diff, on a Unix machine, to work.
      */
-    bool files_same(std::string file1, std::string file2)
+    bool files_same(std::string file1, std::string file2, std::string ignore = "")
     {
         std::string difftool = "diff";
+        if (!ignore.empty()) { difftool += " -I '" + ignore + "'"; }
         std::string cmd = difftool + " " + file1 + " " + file2;
         auto result = system(cmd.c_str());
         return (result == 0);
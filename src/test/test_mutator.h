@@ -9,6 +9,9 @@
 
 #include "test_header.h"
 #include "../mutator.h"
+#include "../point_mutation_models.h"
+
+#include <cmath>
 
 namespace retrocombinator
 {
@@ -26,11 +29,36 @@ namespace retrocombinator
             Sequence s("TTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTT");
             Mutator mutator("K80");
             assert (s.is_active());
-            mutator.mutate_sequence(s, 5);
-            assert (s.num_mutations() == 3);
-            assert (s.as_string() == "TTTTTTTTTTTTTTTTTCTCTTTTTTTTTTTTTTTTTTCT");
+            mutator.mutate_sequence(s, 5, RNG);
+            assert (s.num_mutations() == 7);
+            assert (s.as_string() == "TTTTTTTTTTTTTTCTTTTTTGTTTCATTATTCTTTCTTT");
+            assert (!s.is_active());
 
+            mutator.mutate_sequence(s, 5, RNG);
+            assert (s.num_mutations() == 11);
+            assert (s.as_string() == "TCTTTTTTTTTTTTCTTCTTTGCTTCATTATTCTTTCTTC");
             assert (!s.is_active());
+
+            // Testing that sites change as often as the transition matrix
+            // says, even though not every site is looked at
+            K80Model model;
+            auto tr_mat = model.get_transition_matrix(5);
+            size_type changed_to[Consts::NUC_COUNT] = {0, 0, 0, 0};
+            size_type num_trials = 1000;
+            for (size_type trial = 0; trial < num_trials; ++trial)
+            {
+                Sequence t("TTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTT");
+                mutator.mutate_sequence(t, 5, RNG);
+                for (size_type i = 0; i < t.get_length(); ++i)
+                {
+                    changed_to[Consts::NUC_CHAR2INT(t.char_at(i))] += 1;
+                }
+            }
+            for (int to = 0; to < Consts::NUC_COUNT; ++to)
+            {
+                double observed = double(changed_to[to]) / (num_trials * 40);
+                assert (fabs(observed - tr_mat[Consts::T][to]) < 0.01);
+            }
             return 0;
         }
         catch (Exception e)
@@ -0,0 +1,67 @@
+/**
+ * @file
+ *
+ * \brief To test the functionality of the PackedBases class.
+ *
+ */
+#ifndef TEST_PACKED_BASES_H
+#define TEST_PACKED_BASES_H
+
+#include "test_header.h"
+#include "../packed_bases.h"
+
+namespace retrocombinator
+{
+    /// Tests PackedBases, and sharing of chunks between copies
+    int test_packed_bases()
+    {
+        test_initialize();
+
+        try {
+            // Spans 3 chunks, the last one partially filled
+            size_type n = 2*PackedBases::CHUNK_NUCS + 100;
+            std::string seq_string1(n, 'A');
+            std::string seq_string2(n, 'A');
+            for (size_type i = 0; i < n; i += 7) { seq_string2[i] = 'G'; }
+
+            PackedBases B1(seq_string1);
+            PackedBases B2(seq_string2);
+            assert (B1.num_chunks() == 3);
+            assert (B1.as_string() == seq_string1);
+            assert (B2.as_string() == seq_string2);
+            assert (distance(B1, B2) == (n + 6) / 7);
+
+            // Testing copy-on-write
+            PackedBases B3(B1);
+            assert (B3.shares_chunk(B1, 0) && B3.shares_chunk(B1, 2));
+            B3.set_base(5, Consts::C);
+            assert (!B3.shares_chunk(B1, 0) && B3.shares_chunk(B1, 1));
+            assert (B1.as_string() == seq_string1);
+            assert (B3.base_at(5) == Consts::C && distance(B1, B3) == 1);
+
+            // Testing splicing within a chunk and over whole chunks
+            B3.splice(B2, 10, 2*PackedBases::CHUNK_NUCS + 50);
+            std::string seq_string3(seq_string1);
+            seq_string3[5] = 'C';
+            std::copy(seq_string2.begin() + 10,
+                      seq_string2.begin() + 2*PackedBases::CHUNK_NUCS + 50,
+                      seq_string3.begin() + 10);
+            assert (B3.as_string() == seq_string3);
+            assert (B3.shares_chunk(B2, 1));
+            assert (B2.as_string() == seq_string2);
+
+            // Testing distances that stop early
+            assert (bounded_distance(B1, B2, n) == distance(B1, B2));
+            size_type partial = bounded_distance(B1, B2, 10);
+            assert (partial > 10 && partial < distance(B1, B2));
+
+            return 0;
+        }
+        catch (Exception e)
+        {
+            std::cout << e.what() << std::endl;
+            return 1;
+        }
+    }
+}
+#endif //TEST_PACKED_BASES_H
@@ -0,0 +1,60 @@
+/**
+ * @file
+ *
+ * \brief To test the functionality of the Philox class.
+ *
+ */
+#ifndef TEST_PHILOX_H
+#define TEST_PHILOX_H
+
+#include "test_header.h"
+#include "../philox.h"
+
+namespace retrocombinator
+{
+    /// Tests Philox
+    int test_philox()
+    {
+        try {
+            // Known answers from the Random123 library
+            std::uint32_t out[4];
+            std::uint32_t counter_1[4] = {0, 0, 0, 0};
+            std::uint32_t key_1[2] = {0, 0};
+            Philox::bijection(counter_1, key_1, out);
+            assert (out[0] == 0x6627e8d5 && out[1] == 0xe169c58d &&
+                    out[2] == 0xbc57ac4c && out[3] == 0x9b00dbd8);
+
+            std::uint32_t counter_2[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+            std::uint32_t key_2[2] = {0xa4093822, 0x299f31d0};
+            Philox::bijection(counter_2, key_2, out);
+            assert (out[0] == 0xd16cfe09 && out[1] == 0x94fdcceb &&
+                    out[2] == 0x5001e420 && out[3] == 0x24126ea1);
+
+            // The engine walks through the blocks of its stream
+            Philox engine(0);
+            assert (engine() == 0x6627e8d5);
+            engine.discard(2);
+            assert (engine() == 0x9b00dbd8);
+
+            // Skipping ahead is the same as generating
+            Philox a(42, 1, 2, 3);
+            Philox b(42, 1, 2, 3);
+            for (int i=0; i<11; ++i) { a(); }
+            b.discard(11);
+            assert (a() == b());
+
+            // Different streams give different numbers
+            Philox c(42, 1, 2, 4);
+            Philox d(42, 1, 2, 3);
+            assert (c() != d());
+
+            return 0;
+        }
+        catch (Exception e)
+        {
+            std::cout << e.what() << std::endl;
+            return 1;
+        }
+    }
+}
+#endif // TEST_PHILOX_H
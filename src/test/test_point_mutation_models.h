@@ -10,6 +10,7 @@
 #include "test_header.h"
 #include "../point_mutation_models.h"
 
+#include <algorithm>
 #include <iostream>
 #include <limits>
 
@@ -73,6 +74,39 @@ namespace retrocombinator
             };
             assert (matrix_equal(mat, e_gtr_model_Q));
 
+            // Testing GTR against the closed form for TN93, which it includes
+            GTRModel gtr_tn93(0.1, 0.2, 0.3, 0.4,
+                              /*T2C=*/3, 1, 1, 1, 1, /*A2G=*/7,
+                              0.5);
+            TN93Model tn93_model(0.1, 0.2, 0.3, 0.4, 3, 7, 0.5);
+            for (double t : {0.0, 0.1, 1.0, 25.0})
+            {
+                NucMatrix gtr_mat;
+                mat = gtr_tn93.get_transition_matrix(t);
+                std::copy(&mat[0][0], &mat[0][0] + 16, &gtr_mat[0][0]);
+                assert (matrix_equal(gtr_mat, tn93_model.get_transition_matrix(t)));
+            }
+
+            // Testing that going back to an earlier time gives the same matrix
+            NucMatrix gtr_first;
+            mat = gtr_model.get_transition_matrix(0.0001);
+            std::copy(&mat[0][0], &mat[0][0] + 16, &gtr_first[0][0]);
+            for (int i=0; i<Consts::NUC_COUNT; ++i)
+            {
+                double row_sum = 0;
+                for (int j=0; j<Consts::NUC_COUNT; ++j)
+                {
+                    row_sum += gtr_first[i][j];
+                }
+                assert (fabs(row_sum - 1) < Consts::DOUBLE_TOLERANCE);
+            }
+            for (int step=1; step<=20; ++step)
+            {
+                gtr_model.get_transition_matrix(0.0001 * step);
+            }
+            assert (matrix_equal(gtr_first, gtr_model.get_transition_matrix(0.0001)));
+            assert (matrix_equal(gtr_first, gtr_model.get_transition_matrix(0.0002)) == false);
+
             K80Model k80model;
             mat = k80model.get_transition_matrix(1);
             double e_k80_model_T[][4] = {
@@ -94,6 +128,31 @@ namespace retrocombinator
             };
 
             assert (matrix_equal(mat, e_tn93_model_T));
+            assert (tn93model.get_max_change_probability() == 0);
+            assert (tn93model.sample_row(Consts::A, RNG) == Consts::A);
+
+            // Testing sampling from rows of the transition matrix
+            mat = k80model.get_transition_matrix(5);
+            double p_max = k80model.get_max_change_probability();
+            assert (fabs(p_max - (1 - mat[Consts::C][Consts::C])) < Consts::DOUBLE_TOLERANCE);
+
+            size_type num_samples = 100000;
+            size_type row_counts[Consts::NUC_COUNT] = {0, 0, 0, 0};
+            size_type candidate_counts[Consts::NUC_COUNT] = {0, 0, 0, 0};
+            for (size_type i=0; i<num_samples; ++i)
+            {
+                row_counts[k80model.sample_row(Consts::C, RNG)] += 1;
+                candidate_counts[k80model.sample_candidate(Consts::C, RNG)] += 1;
+            }
+            for (int j=0; j<Consts::NUC_COUNT; ++j)
+            {
+                assert (fabs(double(row_counts[j])/num_samples - mat[Consts::C][j]) < 0.01);
+                if (j != Consts::C)
+                {
+                    assert (fabs(double(candidate_counts[j])/num_samples -
+                                 mat[Consts::C][j]/p_max) < 0.01);
+                }
+            }
 
             return 0;
         }
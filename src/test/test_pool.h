@@ -9,6 +9,7 @@
 
 #include "test_header.h"
 #include "../pool.h"
+#include <map>
 #include <string>
 
 namespace retrocombinator
@@ -29,26 +30,22 @@ namespace retrocombinator
             pool.step(0.1);
 
             std::vector<std::string> expected {
-                "2: TTTTTTTTTTTTTTTTTTTT",
-                "3: TTATTTTTTTATTGTTTTTT",
-                "4: TTCTTTATTTTTTGTTTTTT",
-                "5: TTTTTTTTTTTTTTTTTTTT",
-                "6: TTTTTTTTGTTTTTTATTTT",
-                "7: TTTTTTTTTTTTTATTTTGT",
-                "8: TTTTTTTTTTTTTTGTTTTT",
-                "9: TTCTTTTTTTCTTTTTTGTT",
-               "11: TTTTTTTTTTTTTTTTTTTT",
-               "12: TTATTTTTTTATTTTTTTTT",
-               "13: TTTTTTTTTTTTTATTTTGT",
-               "14: TTTTTTTTTTTTTTTTTTTT",
-               "15: TTTTTTTTTTTTTTTTTTGT",
-               "16: TATTTTTTTTTTTTTTTTTT",
-               "17: TTTTTTTTTTTTTTTTTTTT",
-               "18: TTTTTTTTGTTTTTTATTTT",
-               "19: TTATTTTTTTATTGGTTTTT",
-               "20: TTTTTTTTTTTTTTTATTTT",
-               "21: TTTTTTTTGTTTTTGTTTTT",
-               "22: TTTTTTTTTTTTTTTTTTTT"
+                "1: TTTTTTTTTTTTTATTTTTT",
+                "2: TTTTTTTTTTTATTTTTTTT",
+                "3: TTTGTATTTTTTTTTTTTTT",
+                "4: CTTTTTTTTGATTTTTTGTT",
+                "5: CTTTTTTTTTTTTTTTTTTC",
+                "6: TTTTTTTTTTATTTTCATTT",
+                "7: GTCTTTTATTTTGTTTATTT",
+                "8: TTTTTTTTTTTTTTTTTTTT",
+                "9: TTTGCTTTCTTTTTTTTTTT",
+               "10: TTTTTTTTTATTTTTTTTTT",
+               "11: TTTTTTTTTTTTTATTTTTT",
+               "12: TTTGCTTTCTTTTATTTTTT",
+               "13: TTTTTTTTTATTTATTTTTT",
+               "14: TTTTTATTTTTTTTTTTTTT",
+               "15: TTTTTTTTTATTTTTTTTTT",
+               "16: TTTTTTTTTATTTTTTTTTT"
             };
             assert(expected.size() == pool.get_pool().size());
 
@@ -57,6 +54,40 @@ namespace retrocombinator
                 assert(expected[i] == (std::to_string(seq.get_tag()) + ": " + seq.as_string()));
                 ++i;
             }
+
+            // Recombining when almost every partner is too different: a few
+            // copies of one sequence among many random ones
+            ActivityTracker at(100, 10, 0.0);
+            Sequence::set_activity_tracker(at);
+            sequence_list seqs;
+            seqs.emplace_back(std::string(100, 'A'));
+            for (size_type k = 0; k < 3; ++k) {
+                seqs.emplace_back(seqs.front().get_ancestor());
+            }
+            for (size_type k = 0; k < 60; ++k) {
+                seqs.emplace_back(RNG);
+            }
+            std::map<tag_type, std::string> before;
+            for (const auto& seq : seqs) { before[seq.get_tag()] = seq.as_string(); }
+            const size_type N = seqs.size();
+
+            // similarity must be more than 0.95, so at most 4 differences
+            Burster strict(1.0, 3, 1000, 2, 0.95);
+            strict.burst_sequences(seqs, RNG, 1, nullptr);
+            assert(seqs.size() > N && strict.get_num_full_scans() > 0);
+            for (auto it = std::next(seqs.begin(), N); it != seqs.end(); ++it) {
+                auto parents = it->get_parent_tags();
+                const std::string& s1 = before.at(parents.first);
+                const std::string& s2 = before.at(parents.second);
+                size_type d = 0;
+                for (size_type k = 0; k < s1.size(); ++k) { d += s1[k] != s2[k]; }
+                assert(d <= 4);
+            }
+
+            // with any similarity allowed, random partners are never rejected
+            Burster loose(1.0, 3, 1000, 2, 0.0);
+            loose.burst_sequences(seqs, RNG, 2, nullptr);
+            assert(loose.get_num_full_scans() == 0);
             return 0;
         }
         catch (Exception e)
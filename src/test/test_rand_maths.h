@@ -10,7 +10,9 @@
 
 #include "test_header.h"
 
+#include <cmath>
 #include <iostream>
+#include <numeric>
 
 namespace retrocombinator
 {
@@ -22,13 +24,13 @@ namespace retrocombinator
 
             std::vector<double> k_1 {0.0, 1.0, 2.0, 5.0, 0.0, 0.0, 0.0,10.0, 0.0};
             auto ans_1 = RNG.choose_events<double>(k_1, 100);
-            std::vector<size_type> expected_1{0, 4,10,24, 0, 0, 0,62, 0};
+            std::vector<size_type> expected_1{0, 9,12,22, 0, 0, 0,57, 0};
             assert (std::equal(ans_1.begin(), ans_1.end(),
                                expected_1.begin(), expected_1.end()));
 
             std::vector<size_type> k_2 { 1, 1, 2, 4};
             auto ans_2 = RNG.choose_events<size_type>(k_2, 100);
-            std::vector<size_type> expected_2{13,12,28,47};
+            std::vector<size_type> expected_2{ 8, 9,30,53};
             assert (std::equal(ans_2.begin(), ans_2.end(),
                                expected_2.begin(), expected_2.end()));
 
@@ -40,10 +42,158 @@ namespace retrocombinator
 
             auto ans_4 = RNG.choose_items(
                     std::vector<size_type>   { 1, 1, 2, 0, 0, 5, 1,10},  10);
-            std::vector<size_type> expected_4{ 0, 0, 0, 0, 0, 2, 1, 7};
+            std::vector<size_type> expected_4{ 0, 1, 2, 0, 0, 2, 0, 5};
             assert (std::equal(ans_4.begin(), ans_4.end(),
                                expected_4.begin(), expected_4.end()));
 
+            // Testing the hypergeometric distribution against its mean and
+            // variance, and that picks are spread by the number of items
+            double hyper_sum = 0, hyper_sum_sq = 0;
+            for (size_type trial = 0; trial < 20000; ++trial) {
+                double x = RNG.rand_hypergeometric(30, 70, 20);
+                assert (x <= 20);
+                hyper_sum += x;
+                hyper_sum_sq += x * x;
+            }
+            double hyper_mean = hyper_sum / 20000;
+            assert (std::abs(hyper_mean - 6.0) < 0.05);
+            assert (std::abs(hyper_sum_sq / 20000 - hyper_mean * hyper_mean
+                             - 20 * 0.3 * 0.7 * 80.0 / 99.0) < 0.15);
+            assert (RNG.rand_hypergeometric(5, 0, 3) == 3);
+            assert (RNG.rand_hypergeometric(0, 5, 3) == 0);
+
+            std::vector<size_type> items_5 { 100, 0, 300, 600 };
+            std::vector<double> picks_5(items_5.size(), 0);
+            for (size_type trial = 0; trial < 2000; ++trial) {
+                auto ans_5 = RNG.choose_items(items_5, 500);
+                assert (std::accumulate(ans_5.begin(), ans_5.end(),
+                                        size_type(0)) == 500);
+                for (size_type i = 0; i < items_5.size(); ++i) {
+                    assert (ans_5[i] <= items_5[i]);
+                    picks_5[i] += ans_5[i] / 2000.0;
+                }
+            }
+            assert (std::abs(picks_5[0] - 50) < 1.0 && picks_5[1] == 0);
+            assert (std::abs(picks_5[2] - 150) < 1.0);
+            assert (std::abs(picks_5[3] - 300) < 1.0);
+
+            // Testing that streams depend only on their name and the seed
+            auto stream_1 = RNG.stream(7, 3, Consts::RAND_MUTATION);
+            double first = stream_1.rand_real();
+            RNG.rand_real();
+            auto stream_2 = RNG.stream(7, 3, Consts::RAND_MUTATION);
+            assert (stream_2.rand_real() == first);
+            auto stream_3 = RNG.stream(7, 4, Consts::RAND_MUTATION);
+            assert (stream_3.rand_real() != first);
+            RNG.set_specific_seed(1);
+            auto stream_4 = RNG.stream(7, 3, Consts::RAND_MUTATION);
+            assert (stream_4.rand_real() != first);
+
+            // Testing that the distributions give known numbers (the Poisson
+            // and binomial ones assume a maths library like glibc's)
+            RNG.set_specific_seed(5);
+            auto fixed = RNG.stream(1, 2, Consts::RAND_BURST);
+            std::vector<size_type> expected_6 { 2, 1, 1, 5, 57, 55, 45, 37,
+                                                36, 43, 55, 49, 799, 762, 654, 314 };
+            std::vector<size_type> ans_6;
+            for (size_type i = 0; i < 4; ++i) { ans_6.push_back(fixed.rand_poisson(3.0)); }
+            for (size_type i = 0; i < 4; ++i) { ans_6.push_back(fixed.rand_poisson(50.0)); }
+            for (size_type i = 0; i < 4; ++i) { ans_6.push_back(fixed.rand_binomial(100, 0.5)); }
+            for (size_type i = 0; i < 4; ++i) { ans_6.push_back(fixed.rand_int(0, 1000)); }
+            assert (ans_6 == expected_6);
+
+            // Testing the distributions against their means and variances,
+            // with the parameters for each of their methods
+            auto check_moments = [](std::vector<double> xs, double mean, double var)
+            {
+                double sum = 0, sum_sq = 0;
+                for (double x : xs) { sum += x; sum_sq += x * x; }
+                double sample_mean = sum / xs.size();
+                double sample_var = sum_sq / xs.size() - sample_mean * sample_mean;
+                return std::abs(sample_mean - mean) < 0.02 * (1 + mean) &&
+                       std::abs(sample_var - var) < 0.05 * (1 + var);
+            };
+            const size_type M = 50000;
+            for (double mean : {0.5, 3.0, 9.5, 10.0, 40.0, 1000.0}) {
+                std::vector<double> xs;
+                for (size_type i = 0; i < M; ++i) { xs.push_back(RNG.rand_poisson(mean)); }
+                assert (check_moments(xs, mean, mean));
+            }
+            for (double p : {0.01, 0.3, 0.5, 0.9}) {
+                std::vector<double> xs;
+                for (size_type i = 0; i < M; ++i) { xs.push_back(RNG.rand_binomial(200, p)); }
+                assert (check_moments(xs, 200 * p, 200 * p * (1 - p)));
+            }
+            assert (RNG.rand_binomial(7, 1.0) == 7 && RNG.rand_binomial(7, 0.0) == 0);
+            std::vector<double> ints;
+            for (size_type i = 0; i < M; ++i) {
+                size_type x = RNG.rand_int(3, 10);
+                assert (x >= 3 && x < 10);
+                ints.push_back(x);
+            }
+            assert (check_moments(ints, 6.0, 4.0));
+
+            // Testing bulk generation
+            const size_type N = 100000;
+            std::vector<double> uniforms(N);
+            RNG.fill_uniform(uniforms.data(), N);
+            double uniform_sum = 0;
+            for (double u : uniforms) {
+                assert (u >= 0.0 && u < 1.0);
+                uniform_sum += u;
+            }
+            assert (std::abs(uniform_sum / N - 0.5) < 0.01);
+
+            std::vector<std::uint64_t> bits(N);
+            RNG.fill_bits(bits.data(), N);
+            double bit_count = 0;
+            for (auto word : bits) {
+                bit_count += __builtin_popcountll(word);
+            }
+            assert (std::abs(bit_count / (64.0 * N) - 0.5) < 0.01);
+
+            std::vector<size_type> counts(N);
+            RNG.fill_geometric(counts.data(), N, 0.2);
+            double geometric_sum = 0;
+            for (auto x : counts) { geometric_sum += x; }
+            assert (std::abs(geometric_sum / N - 4.0) < 0.1);
+
+            RNG.fill_poisson(counts.data(), N, 3.5);
+            double poisson_sum = 0;
+            for (auto x : counts) { poisson_sum += x; }
+            assert (std::abs(poisson_sum / N - 3.5) < 0.05);
+            for (double mean : {0.3, 3.5, 25.0}) {
+                auto bulk_rng = RNG.stream(3, 1, Consts::RAND_BURST);
+                auto single_rng = RNG.stream(3, 1, Consts::RAND_BURST);
+                bulk_rng.fill_poisson(counts.data(), 200, mean);
+                for (size_type i = 0; i < 200; ++i) {
+                    assert (counts[i] == single_rng.rand_poisson(mean));
+                }
+            }
+
+            // Testing sampling without replacement, with few values picked
+            // (Floyd's algorithm) and with many (selection sampling)
+            for (size_type m : {0, 1, 3, 40, 90, 100}) {
+                auto sample = RNG.sample_without_replacement(5, 105, m);
+                assert (sample.size() == m);
+                for (size_type i = 0; i < m; ++i) {
+                    assert (sample[i] >= 5 && sample[i] < 105);
+                    assert (i == 0 || sample[i-1] < sample[i]);
+                }
+            }
+            std::vector<size_type> picked(10, 0);
+            for (size_type trial = 0; trial < 20000; ++trial) {
+                for (auto x : RNG.sample_without_replacement(0, 10, 2)) {
+                    ++picked[x];
+                }
+                for (auto x : RNG.sample_without_replacement(0, 10, 7)) {
+                    ++picked[x];
+                }
+            }
+            for (auto count : picked) {
+                assert (std::abs(count / 20000.0 - 0.9) < 0.03);
+            }
+
             return 0;
         }
         catch (Exception e)
@@ -30,25 +30,25 @@ namespace retrocombinator
             assert (S1.as_string() == seq_string1);
 
             // Testing random sequence generation
-            Sequence S2;
-            assert (S2.as_string() == "GGGGCATAATGA");
+            Sequence S2(RNG);
+            assert (S2.as_string() == "CCCGTAAGGCAT");
 
             // Testing non-lethal point mutations
             std::string seq_string3("TTTTTTTTTTTT");
             Sequence S3(seq_string3);
             assert (S3.num_mutations() == 0);
 
-            S3.point_mutate(2, 'C');
+            S3.point_mutate(2, 'C', RNG);
             assert (S3.as_string() == "TTCTTTTTTTTT");
             assert (S3.num_mutations() == 1);
 
-            S3.point_mutate(4, 'A');
+            S3.point_mutate(4, 'A', RNG);
             assert (S3.as_string() == "TTCTATTTTTTT");
             assert (S3.num_mutations() == 2);
 
             // Testing lethal point mutations
             assert (S3.is_active());
-            S3.point_mutate(1, 'G');
+            S3.point_mutate(1, 'G', RNG);
             assert (S3.as_string() == "TGCTATTTTTTT");
             assert (S3.num_mutations() == 3);
             // Testing sequence similarity as a percentage
@@ -71,13 +71,13 @@ namespace retrocombinator
             std::string seq_string6("GGGGGGGGGGGG");
             Sequence S6(seq_string6);
 
-            Sequence S7(S5, S6, 1);
-            Sequence S8(S5, S6, 2);
-            Sequence S9(S5, S6, 3);
+            Sequence S7(S5, S6, 1, RNG);
+            Sequence S8(S5, S6, 2, RNG);
+            Sequence S9(S5, S6, 3, RNG);
 
-            assert (S7.as_string() == "GGGGGGGGGGAA");
-            assert (S8.as_string() == "AGGGAAAAAAAA");
-            assert (S9.as_string() == "AGGGGAAAGGGG");
+            assert (S7.as_string() == "GGGGAAAAAAAA");
+            assert (S8.as_string() == "AGGGGGGAAAAA");
+            assert (S9.as_string() == "AAGAAAAAAAAG");
 
             // Testing individual sequence tagging
             assert (S1.get_tag() == 1);
@@ -96,6 +96,91 @@ namespace retrocombinator
             assert (S8.get_parent_tags().first  == S5.get_tag() &&
                     S8.get_parent_tags().second == S6.get_tag());
 
+            // Testing sequences that span several packed words
+            ActivityTracker at_long(70, 2, 0.0);
+            Sequence::set_activity_tracker(at_long);
+
+            std::string seq_string10(70, 'A');
+            std::string seq_string11(70, 'C');
+            seq_string10[31] = 'G'; seq_string10[32] = 'T'; seq_string10[69] = 'C';
+            Sequence S10(seq_string10);
+            Sequence S11(seq_string11);
+            assert (S10.as_string() == seq_string10);
+            assert (S10 * S11 == 69);
+            assert (S10 * seq_string10 == 0);
+
+            Sequence S12(S10, S11, 2, RNG);
+            std::string s12 = S12.as_string();
+            size_type switches = 0;
+            for (size_type i = 1; i < s12.size(); ++i) {
+                bool from_s11 = (s12[i] == 'C' && i != 69);
+                bool prev_from_s11 = (s12[i-1] == 'C');
+                if (from_s11 != prev_from_s11) { ++switches; }
+            }
+            assert (switches == 2);
+            assert (S12 * S10 + S12 * S11 == 69);
+
+            // Testing that recombinants keep the mutations of each segment
+            for (size_type i = 0; i < 70; i += 5) {
+                S10.point_mutate(i, 'T', RNG);
+                S11.point_mutate(i+1, 'T', RNG);
+            }
+            assert (S10.num_mutations() == 14 && S11.num_mutations() == 14);
+            assert (S10.num_critical_mutations() == 1);
+            assert (S11.num_critical_mutations() == 1);
+            Sequence S13(S10, S11, 2, RNG);
+            std::string s13 = S13.as_string();
+            size_type expected_mutations = 0;
+            for (size_type i = 0; i < s13.size(); ++i) {
+                if (s13[i] == 'T' && seq_string10[i] != 'T' && seq_string11[i] != 'T') {
+                    ++expected_mutations;
+                }
+            }
+            assert (S13.num_mutations() == expected_mutations);
+            S10.point_mutate(5, 'A', RNG);
+            assert (S10.num_mutations() == 13);
+
+            // Testing sparse sequences, stored as mutations on an ancestor
+            Sequence::set_sparse_divergence(0.1);
+            Sequence S14(seq_string10);
+            Sequence S15(S14.get_ancestor());
+            Sequence S16(S14.get_ancestor());
+            assert (S14.is_sparse() && S15.is_sparse());
+            S15.point_mutate(3, 'G', RNG);
+            S15.point_mutate(40, 'T', RNG);
+            S16.point_mutate(40, 'T', RNG);
+            S16.point_mutate(41, 'C', RNG);
+            S16.point_mutate(41, 'A', RNG);
+            assert (S15.is_sparse() && S16.num_mutations() == 1);
+            assert (S15.char_at(3) == 'G' && S15.char_at(4) == 'A');
+            assert (S15 * S16 == 1 && S14 * S15 == 2);
+            assert (S15 * S16.as_string() == 1);
+            assert (!within_distance(S14, S15, 1));
+
+            // Testing comparisons against packed nucleotides
+            PackedBases packed15 = S15.dense_bases();
+            assert (packed15.as_string() == S15.as_string());
+            assert (S15 * packed15 == 0 && S16 * packed15 == 1);
+            assert (within_distance(S14, packed15, 2) &&
+                    !within_distance(S14, packed15, 1));
+            assert (bounded_distance(S14, packed15, 0) > 0);
+
+            Sequence S17(S15, S16, 1, RNG);
+            assert (S17.is_sparse());
+            assert (S17 * S14 == S17.as_string() * seq_string10);
+
+            // Sparse sequences compared against dense ones, and made dense
+            // when they diverge too far
+            assert (S15 * S10 == S15.as_string() * S10.as_string());
+            for (size_type i = 50; i < 56; ++i) {
+                S16.point_mutate(i, 'G', RNG);
+            }
+            assert (!S16.is_sparse() && S16.num_mutations() == 7);
+            assert (S16 * S15 == S16.as_string() * S15.as_string());
+            Sequence S18(S15, S16, 2, RNG);
+            assert (!S18.is_sparse());
+            Sequence::set_sparse_divergence(Consts::SPARSE_DIVERGENCE_DEFAULT);
+
             return 0;
         }
         catch (Exception e)
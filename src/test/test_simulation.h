@@ -14,56 +14,58 @@ namespace retrocombinator
 {
     int test_simulation()
     {
-        test_initialize();
         try {
             std::string init_seq("TTTTTTTTTTTTTTTTTTTT");
-
-            Simulation simulation(
-                init_seq, init_seq.length(), 10,
-                /* ActivityTracker */ 5, 1.0,
-                /* Mutator */ "TN93",
-                /* Burst */ 0.8, 3, 20,
-                /* Recomb */ 3, 0.1,
-                /* Select */ 0.5,
-                /* Family */ 0.7, 10,
-                /* Timesteps */ 10, 0.1,
-                /* Output */ "./test_obj/test_simulation.out", 2, 2, 2, 2, 0.5
-            );
-
             std::vector<std::string> expected {
-                    "3: TTCTTTTTGTATTTTGAATT",
-                   "30: CTTAGTTTGTTTTTAGGCTT",
-                   "31: GTTTAACACTTAATCTTTTA",
-                   "33: GGTTTTGTCCCTCTGTTTTC",
-                   "36: TATTTCTATCATTTGTTATT",
-                   "40: TTTCCTATACTTTCGTCTTA",
-                   "46: TTTTGTATTTTATATTTTGT",
-                   "48: TTTTGGCTTATTTTTTTTTT",
-                   "50: TTTTGATCTTTTTTGTTTAA",
-                   "55: TCTTTTTTAATTTAGTTTTC",
-                   "57: TCTTTGTTGTATCAGCTTTT",
-                   "58: TTTTCTGTGCTTTAGTTTAT",
-                   "59: TTTTTTTCGCTTTTTTATTT",
-                   "60: TTTTTGTTGATTTAGATTTT",
-                   "61: ATTTATTTGGATAAGTTTGT",
-                   "62: GTTTAGTAGTTTTTCTCTTT",
-                   "63: TTTTTATCCTTTTTGTTTTT",
-                   "64: TTTTGTACCTTATATTTTTT",
-                   "65: TTTTTAATACTTTCGTCTTT"
+                    "2: TTTAATGCTTTGTTATGCTT",
+                    "5: CTGGTTCTGAGTTTGTGATT",
+                    "8: CTTGTTCTGTTCCTTAAATT",
+                   "10: GGTTTTAATACCTTTATGGT",
+                   "11: CTTGTCTTTTTTTACCGTAT",
+                   "13: ATCTTTGGTGGTCAATATTT",
+                   "14: GTTTGAGTGCTCACTCTTTT",
+                   "18: TTTTTGATATTCTATCGGTT",
+                   "19: ATGCTTACTTTTTCTAAGTT",
+                   "20: GTTGTTTAATTTTTCTCCCT",
+                   "24: GGTTTTATCGAATTCGTTTG",
+                   "27: CATTCTTTTTGAGTATGTTT",
+                   "29: TTTGATATTTTTAATCATTA",
+                   "30: TTTCGTATGCGTATCATTTA"
             };
-            simulation.print_seed(false, RNG.get_last_seed());
-            simulation.simulate();
 
-            assert(expected.size() == simulation.get_pool().size());
+            // Keeping the distances between sequences only changes how fast
+            // the simulation is, so both give the same output
+            for (bool track_distances : {false, true}) {
+                test_initialize();
+                Simulation simulation(
+                    init_seq, init_seq.length(), 10,
+                    /* ActivityTracker */ 5, 1.0,
+                    /* Mutator */ "TN93",
+                    /* Burst */ 0.8, 3, 20,
+                    /* Recomb */ 3, 0.1,
+                    /* Select */ 0.5,
+                    // update families on every step, as they were before
+                    // updates were scheduled
+                    /* Family */ 0.7, 10, 1, 1, 0.0,
+                    /* Timesteps */ 10, 0.1, track_distances,
+                    /* Output */ "./test_obj/test_simulation.out", 2, 2, 2, 2, 0.5
+                );
 
-            size_type i = 0;
-            for(const auto& seq : simulation.get_pool()) {
-                assert(expected[i] == (std::to_string(seq.get_tag()) + ": " + seq.as_string()));
-                ++i;
-            }
+                simulation.print_seed(false, RNG.get_last_seed());
+                simulation.simulate();
 
-            assert(files_same("./test_obj/test_simulation.out",
-                              "./src/test/test_simulation.expected"));
+                assert(expected.size() == simulation.get_pool().size());
+
+                size_type i = 0;
+                for(const auto& seq : simulation.get_pool()) {
+                    assert(expected[i] == (std::to_string(seq.get_tag()) + ": " + seq.as_string()));
+                    ++i;
+                }
+
+                assert(files_same("./test_obj/test_simulation.out",
+                                  "./src/test/test_simulation.expected",
+                                  track_distances ? "^SimulationParams_trackDistances:" : ""));
+            }
             return 0;
         }
         catch (Exception e)
@@ -0,0 +1,62 @@
+/**
+ * @file
+ *
+ * \brief To test the functionality of the UnionFind class.
+ *
+ */
+#ifndef TEST_UNION_FIND_H
+#define TEST_UNION_FIND_H
+
+#include "test_header.h"
+#include "../union_find.h"
+
+#include <thread>
+
+namespace retrocombinator
+{
+    /// Tests UnionFind
+    int test_union_find()
+    {
+        test_initialize();
+
+        try {
+            // The root of every set is its smallest index
+            UnionFind sets(6);
+            assert (sets.size() == 6 && sets.find(4) == 4);
+            assert (sets.unite(4, 2));
+            assert (sets.unite(5, 4));
+            assert (!sets.unite(2, 5));
+            assert (sets.find(5) == 2 && sets.same_set(4, 5));
+            assert (sets.unite(3, 0));
+            assert (!sets.same_set(0, 2) && sets.find(1) == 1);
+            assert (sets.unite(3, 5));
+            assert (sets.find(4) == 0 && sets.find(2) == 0);
+
+            // Merging from several threads at once gives the same sets: here
+            // every index is joined to the one 5 further along
+            const size_type n = 10000;
+            UnionFind shared(n);
+            std::vector<std::thread> workers;
+            for (size_type t = 0; t < 4; ++t) {
+                workers.emplace_back([&shared, t]() {
+                    for (size_type i = t; i + 5 < n; i += 4) {
+                        shared.unite(i + 5, i);
+                    }
+                });
+            }
+            for (auto& worker : workers) { worker.join(); }
+            for (size_type i = 0; i < n; ++i) {
+                assert (shared.find(i) == i % 5);
+            }
+
+            return 0;
+        }
+        catch (Exception e)
+        {
+            std::cout << e.what() << std::endl;
+            return 1;
+        }
+    }
+}
+
+#endif // TEST_UNION_FIND_H
@@ -8,6 +8,9 @@
 
 #include "test_header.h"
 #include "../utilities.h"
+#include "../sequence.h"
+
+#include <map>
 
 namespace retrocombinator
 {
@@ -34,7 +37,6 @@ namespace retrocombinator
         test_initialize();
         try {
 
-            size_type n_1 = 5;
             dist_type mat_1 = {
                 dist_row_type {  0, 17, 21, 31, 23 },
                 dist_row_type { 17,  0, 30, 34, 21 },
@@ -44,7 +46,7 @@ namespace retrocombinator
             };
 
             assert(check_clusters_equal(
-                Utils::cluster_slink(mat_1, n_1, 20),
+                Utils::cluster_slink(CondensedMatrix(mat_1), 20),
                 std::vector<Utils::cluster_type> {
                     Utils::cluster_type {0, 1},
                     Utils::cluster_type {2},
@@ -53,7 +55,6 @@ namespace retrocombinator
                 }
             ));
 
-            size_type n_2 = 7;
             dist_type mat_2 = {
                 //               a   b   c   d   e   f   g
                 dist_row_type {  0, 11, 91, 91, 93, 34, 94 }, // a
@@ -66,7 +67,7 @@ namespace retrocombinator
             };
 
             assert(check_clusters_equal(
-                Utils::cluster_slink(mat_2, n_2, 20),
+                Utils::cluster_slink(CondensedMatrix(mat_2), 20),
                 std::vector<Utils::cluster_type> {
                     Utils::cluster_type {0, 1},
                     Utils::cluster_type {2, 3},
@@ -76,7 +77,7 @@ namespace retrocombinator
             ));
 
             assert(check_clusters_equal(
-                Utils::cluster_slink(mat_2, n_2, 30),
+                Utils::cluster_slink(CondensedMatrix(mat_2), 30),
                 std::vector<Utils::cluster_type> {
                     Utils::cluster_type {0, 1, 2, 3},
                     Utils::cluster_type {4, 5},
@@ -85,14 +86,13 @@ namespace retrocombinator
             ));
 
             assert(check_clusters_equal(
-                Utils::cluster_slink(mat_2, n_2, 40),
+                Utils::cluster_slink(CondensedMatrix(mat_2), 40),
                 std::vector<Utils::cluster_type> {
                     Utils::cluster_type {0, 1, 2, 3, 4, 5},
                     Utils::cluster_type {6},
                 }
             ));
 
-            size_type n_3 = 7;
             dist_type mat_3 = {
                 //               a   b   c   d   e   f   g
                 dist_row_type {  0, 15, 91, 10, 93, 94, 11 }, // a
@@ -105,7 +105,7 @@ namespace retrocombinator
             };
 
             assert(check_clusters_equal(
-                Utils::cluster_slink(mat_3, n_3, 10),
+                Utils::cluster_slink(CondensedMatrix(mat_3), 10),
                 std::vector<Utils::cluster_type> {
                     Utils::cluster_type {0},
                     Utils::cluster_type {1},
@@ -118,7 +118,7 @@ namespace retrocombinator
             ));
 
             assert(check_clusters_equal(
-                Utils::cluster_slink(mat_3, n_3, 11),
+                Utils::cluster_slink(CondensedMatrix(mat_3), 11),
                 std::vector<Utils::cluster_type> {
                     Utils::cluster_type {0, 3},
                     Utils::cluster_type {1},
@@ -130,7 +130,7 @@ namespace retrocombinator
             ));
 
             assert(check_clusters_equal(
-                Utils::cluster_slink(mat_3, n_3, 20),
+                Utils::cluster_slink(CondensedMatrix(mat_3), 20),
                 std::vector<Utils::cluster_type> {
                     Utils::cluster_type {0, 1, 3, 6},
                     Utils::cluster_type {2, 4},
@@ -138,11 +138,11 @@ namespace retrocombinator
                 }
             ));
 
-            assert((Utils::select_representatives(Utils::cluster_slink(mat_3, n_3, 20)) ==
+            assert((Utils::select_representatives(Utils::cluster_slink(CondensedMatrix(mat_3), 20)) ==
                     std::vector<size_type> { 0, 2, 5 }));
 
             assert(check_clusters_equal(
-                Utils::cluster_slink(mat_3, n_3, 30),
+                Utils::cluster_slink(CondensedMatrix(mat_3), 30),
                 std::vector<Utils::cluster_type> {
                     Utils::cluster_type {0, 1, 3, 6},
                     Utils::cluster_type {2, 4, 5},
@@ -150,12 +150,115 @@ namespace retrocombinator
             ));
 
             assert(check_clusters_equal(
-                Utils::cluster_slink(mat_3, n_3, 32),
+                Utils::cluster_slink(CondensedMatrix(mat_3), 32),
                 std::vector<Utils::cluster_type> {
                     Utils::cluster_type {0, 1, 2, 3, 4, 5, 6},
                 }
             ));
 
+            // Single linkage clusters are the connected components of the
+            // points closer than the threshold
+            size_type n_4 = 40;
+            CondensedMatrix mat_4(n_4, 100);
+            for (size_type i = 0; i < n_4; ++i) {
+                for (size_type j = i+1; j < n_4; ++j) {
+                    mat_4.set(i, j, RNG.rand_int(0, 100));
+                }
+            }
+            std::vector<size_type> component(n_4, n_4);
+            for (size_type i = 0; i < n_4; ++i) {
+                if (component[i] != n_4) { continue; }
+                std::vector<size_type> to_visit { i };
+                component[i] = i;
+                while (!to_visit.empty()) {
+                    size_type v = to_visit.back();
+                    to_visit.pop_back();
+                    for (size_type u = 0; u < n_4; ++u) {
+                        if (component[u] == n_4 && mat_4.get(u, v) < 3) {
+                            component[u] = i;
+                            to_visit.push_back(u);
+                        }
+                    }
+                }
+            }
+            // components are named by their first point, so the map lists
+            // them in the order of their first points
+            std::map<size_type, Utils::cluster_type> components;
+            for (size_type i = 0; i < n_4; ++i) {
+                components[component[i]].insert(i);
+            }
+            std::vector<Utils::cluster_type> expected_4;
+            for (const auto& named : components) {
+                expected_4.push_back(named.second);
+            }
+            assert(expected_4.size() > 1 && expected_4.size() < n_4);
+            assert(check_clusters_equal(Utils::cluster_slink(mat_4, 3), expected_4));
+
+            // Connected components of the pairs closer than the threshold give
+            // the same clusters, whether found on one thread or several
+            auto closer_than = [](const CondensedMatrix& mat, size_type threshold) {
+                return [&mat, threshold](size_type i, size_type j) {
+                    return mat.get(i, j) < threshold;
+                };
+            };
+            assert(check_clusters_equal(
+                Utils::cluster_threshold(5, closer_than(CondensedMatrix(mat_1), 20)),
+                Utils::cluster_slink(CondensedMatrix(mat_1), 20)));
+            for (size_type threshold : {10, 11, 20, 30, 32}) {
+                CondensedMatrix mat(mat_3);
+                assert(check_clusters_equal(
+                    Utils::cluster_threshold(7, closer_than(mat, threshold)),
+                    Utils::cluster_slink(mat, threshold)));
+            }
+            assert(check_clusters_equal(
+                Utils::cluster_threshold(n_4, closer_than(mat_4, 3)), expected_4));
+            assert(Utils::cluster_threshold(0, closer_than(mat_4, 3)).empty());
+
+            size_type n_5 = 600;
+            CondensedMatrix mat_5(n_5, 2000);
+            for (size_type i = 0; i < n_5; ++i) {
+                for (size_type j = i+1; j < n_5; ++j) {
+                    mat_5.set(i, j, RNG.rand_int(0, 2000));
+                }
+            }
+            for (size_type threshold : {1, 2, 4}) {
+                auto serial = Utils::cluster_threshold(n_5, closer_than(mat_5, threshold), 1);
+                assert(serial.size() > 1 && serial.size() < n_5);
+                assert(check_clusters_equal(serial, Utils::cluster_slink(mat_5, threshold)));
+                assert(check_clusters_equal(serial,
+                    Utils::cluster_threshold(n_5, closer_than(mat_5, threshold), 8)));
+            }
+
+            // The same with sequences compared on several threads at once,
+            // stopping early as the families do
+            ActivityTracker at(100, 2, 0.0);
+            Sequence::set_activity_tracker(at);
+            sequence_list seqs;
+            seqs.emplace_back(std::string(100, 'A'));
+            for (size_type k = 1; k < 300; ++k) {
+                seqs.emplace_back(seqs.front().get_ancestor());
+                for (size_type m = RNG.rand_int(0, 12); m > 0; --m) {
+                    seqs.back().point_mutate(RNG.rand_int(0, 100),
+                                             Consts::NUC_INT2CHAR(RNG.rand_int(0, 4)), RNG);
+                }
+            }
+            std::vector<const Sequence*> seq_ptrs;
+            for (const auto& s : seqs) { seq_ptrs.push_back(&s); }
+            CondensedMatrix seq_dist(seq_ptrs.size(), 100);
+            for (size_type i = 0; i < seq_ptrs.size(); ++i) {
+                for (size_type j = i+1; j < seq_ptrs.size(); ++j) {
+                    seq_dist.set(i, j, *seq_ptrs[i] * *seq_ptrs[j]);
+                }
+            }
+            auto seqs_closer = [&seq_ptrs](size_type i, size_type j) {
+                return within_distance(*seq_ptrs[i], *seq_ptrs[j], 2);
+            };
+            auto seq_clusters = Utils::cluster_threshold(seq_ptrs.size(), seqs_closer, 4);
+            assert(seq_clusters.size() > 1 && seq_clusters.size() < seq_ptrs.size());
+            assert(check_clusters_equal(seq_clusters, Utils::cluster_slink(seq_dist, 3)));
+            assert(check_clusters_equal(seq_clusters,
+                Utils::cluster_threshold(seq_ptrs.size(), seqs_closer, 1)));
+
             return 0;
         }
         catch (Exception e)
@@ -0,0 +1,104 @@
+/**
+ * @file
+ *
+ * \brief To test the functionality of the WeightedSampler class.
+ *
+ */
+#ifndef TEST_WEIGHTED_SAMPLER_H
+#define TEST_WEIGHTED_SAMPLER_H
+
+#include "test_header.h"
+#include "../weighted_sampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace retrocombinator
+{
+    /// Tests WeightedSampler
+    int test_weighted_sampler()
+    {
+        test_initialize();
+
+        try {
+            // Events with no weight are never picked
+            WeightedSampler sampler_1(std::vector<double> {0.0, 1.0, 0.0});
+            assert (sampler_1.size() == 3);
+            assert (sampler_1.sample(0.0) == 1);
+            assert (sampler_1.sample(0.5) == 1);
+            assert (sampler_1.sample(0.99) == 1);
+
+            // Leading events with no weight are not picked either, even when
+            // the weights they had leave rounding errors in the tree
+            std::vector<double> weights_0 {0.0, 0.0, 1.0, 2.0, 0.0};
+            WeightedSampler sampler_0(weights_0);
+            sampler_0.set_weight(0, 0.1);
+            sampler_0.set_weight(1, 0.2);
+            sampler_0.set_weight(0, 0.0);
+            sampler_0.set_weight(1, 0.0);
+            for (double u : {0.0, 1e-18, 0.2, 0.5, 0.999999}) {
+                size_type event = sampler_0.sample(u);
+                assert (weights_0[event] > 0);
+            }
+            assert (sampler_0.sample(0.0) == 2);
+            assert (sampler_0.sample(0.999999) == 3);
+
+            // Cumulative weights are kept up to date
+            std::vector<double> weights_2 {0.0, 1.0, 2.0, 5.0, 0.5, 1.5, 0.0};
+            WeightedSampler sampler_2(weights_2);
+            assert (sampler_2.total() == 10.0);
+            assert (sampler_2.prefix_total(4) == 8.0);
+            sampler_2.set_weight(3, 1.0);
+            sampler_2.set_weight(6, 4.0);
+            weights_2[3] = 1.0;
+            weights_2[6] = 4.0;
+            assert (sampler_2.total() == 10.0);
+            assert (sampler_2.get_weight(6) == 4.0);
+            assert (sampler_2.sample(0.35) == 3);
+
+            // Every event is picked as often as its weight
+            size_type counts[7] = {0, 0, 0, 0, 0, 0, 0};
+            size_type num_samples = 100000;
+            for (size_type i=0; i<num_samples; ++i)
+            {
+                counts[sampler_2.sample(RNG.rand_real())] += 1;
+            }
+            for (size_type j=0; j<7; ++j)
+            {
+                assert (fabs(double(counts[j])/num_samples - weights_2[j]/10.0) < 0.01);
+            }
+
+            // Batches of samples are sorted
+            std::vector<double> us(1000);
+            RNG.fill_uniform(us.data(), us.size());
+            auto batch = sampler_2.sample_sorted(us);
+            assert (batch.size() == 1000);
+            assert (std::is_sorted(batch.begin(), batch.end()));
+
+            // Weights must make sense
+            bool thrown = false;
+            sampler_1.set_weight(1, 0.0);
+            try { sampler_1.sample(0.5); }
+            catch (Exception e) { thrown = true; }
+            assert (thrown);
+            thrown = false;
+            sampler_0.set_weight(2, 0.0);
+            sampler_0.set_weight(3, 0.0);
+            try { sampler_0.sample(0.5); }
+            catch (Exception e) { thrown = true; }
+            assert (thrown);
+            thrown = false;
+            try { sampler_1.set_weight(0, -1.0); }
+            catch (Exception e) { thrown = true; }
+            assert (thrown);
+
+            return 0;
+        }
+        catch (Exception e)
+        {
+            std::cout << e.what() << std::endl;
+            return 1;
+        }
+    }
+}
+#endif // TEST_WEIGHTED_SAMPLER_H
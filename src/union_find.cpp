@@ -0,0 +1,52 @@
+#include "union_find.h"
+
+#include <utility>
+
+using namespace retrocombinator;
+
+UnionFind::UnionFind(size_type n) :
+    parent(n)
+{
+    for (size_type i=0; i<n; ++i)
+    {
+        parent[i].store(i, std::memory_order_relaxed);
+    }
+}
+
+size_type UnionFind::find(size_type i)
+{
+    while (true)
+    {
+        size_type p = parent[i].load(std::memory_order_acquire);
+        if (p == i) { return i; }
+        size_type grandparent = parent[p].load(std::memory_order_acquire);
+        if (grandparent != p)
+        {
+            // point i past its parent; if someone else moved it, that is fine
+            parent[i].compare_exchange_weak(p, grandparent,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed);
+        }
+        i = grandparent;
+    }
+}
+
+bool UnionFind::unite(size_type i, size_type j)
+{
+    while (true)
+    {
+        i = find(i);
+        j = find(j);
+        if (i == j) { return false; }
+        if (i < j) { std::swap(i, j); }
+
+        // i is the larger root: link it to j, unless it stopped being a root
+        size_type expected = i;
+        if (parent[i].compare_exchange_strong(expected, j,
+                                              std::memory_order_acq_rel,
+                                              std::memory_order_acquire))
+        {
+            return true;
+        }
+    }
+}
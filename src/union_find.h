@@ -0,0 +1,59 @@
+/**
+ * @file
+ *
+ * \brief For the UnionFind class, disjoint sets that several threads can
+ * merge at once
+ */
+#ifndef UNION_FIND_H
+#define UNION_FIND_H
+
+#include "constants.h"
+
+#include <atomic>
+#include <vector>
+
+namespace retrocombinator
+{
+    /** Disjoint sets over the indices [0, n), that can be merged and queried
+     *  by several threads at the same time without locks.
+     *
+     *  Each index points to a smaller index in its set, or to itself if it is
+     *  the root, so the root of a set is always its smallest index. Sets are
+     *  merged by swinging the larger root onto the smaller one with a
+     *  compare-and-swap, and paths are shortened (halved) as they are walked.
+     */
+    class UnionFind
+    {
+    private:
+        /// The index each index points to
+        std::vector<std::atomic<size_type> > parent;
+
+    public:
+        /// \a n indices, each in a set of its own
+        explicit UnionFind(size_type n);
+
+        /// Number of indices
+        size_type size() const { return parent.size(); }
+
+        /** Returns the smallest index in the set of \a i.
+         *  While other threads are merging sets, the answer may already be out
+         *  of date (but is never smaller than the true root).
+         */
+        size_type find(size_type i);
+
+        /** Merges the sets of \a i and \a j.
+         *  Returns true if they were in different sets before.
+         */
+        bool unite(size_type i, size_type j);
+
+        /** Are \a i and \a j known to be in the same set?
+         *  A true answer is final, as sets are never split.
+         */
+        bool same_set(size_type i, size_type j)
+        {
+            return find(i) == find(j);
+        }
+    };
+}
+
+#endif // UNION_FIND_H
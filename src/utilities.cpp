@@ -7,83 +7,66 @@ using namespace retrocombinator;
 
 namespace retrocombinator {
     std::vector<Utils::cluster_type> Utils::cluster_slink(
-            dist_type dist, size_type n, size_type join_threshold_max)
+            const CondensedMatrix& dist, size_type join_threshold_max)
     {
-        typedef std::pair<size_type, size_type> edge_type;
         size_type INFTY = std::numeric_limits<size_type>::max();
+        size_type n = dist.size();
 
-        // Initially, each cluster is just the number
-        std::vector<cluster_type> clusters;
-        for (size_type i=0; i<n; ++i) {
-            clusters.emplace_back(cluster_type { i });
-        }
+        // Single linkage clusters are the connected components that are left
+        // when the edges of a minimum spanning tree that are not shorter than
+        // the threshold are cut. So grow a minimum spanning tree with Prim's
+        // algorithm, which only needs one row of distances at a time.
+        std::vector<bool> in_tree(n, false);
+        std::vector<size_type> nearest_dist(n, INFTY);
+        std::vector<size_type> nearest(n, 0);
 
-        // Get the nearest neighbour for each cluster
-        std::vector<edge_type> nearest;
-        for (size_type i=0; i<n; ++i) {
-            size_type cur_nearest = -1;
-            size_type cur_dist = INFTY;
-            for (size_type j=0; j<n; ++j) {
-                if (j != i && dist[i][j] < cur_dist) {
-                    cur_nearest = j;
-                    cur_dist = dist[i][j];
-                }
-            }
-            nearest.emplace_back(edge_type{cur_nearest, cur_dist});
-        }
+        // Each point points to an earlier point in its cluster (or itself)
+        std::vector<size_type> parent(n);
+        for (size_type i=0; i<n; ++i) { parent[i] = i; }
+        auto find_root = [&parent](size_type i)
+        {
+            while (parent[i] != i) { i = parent[i] = parent[parent[i]]; }
+            return i;
+        };
 
-        // Start at 1 so we only do n-1 steps
-        for(size_type loop = 1; loop < n; ++loop) {
-
-            // 1) Find the nearest distance between clusters
-            size_type best = 0;
-            size_type best_dist = INFTY;
-            for (size_type i=0; i<n; ++i) {
-                if (nearest[i].second < best_dist) {
-                    best = i;
-                    best_dist = nearest[i].second;
+        for (size_type added=0, v=0; added<n; ++added) {
+            // the point closest to the tree joins it (the first is point 0)
+            if (added > 0) {
+                size_type best_dist = INFTY;
+                for (size_type u=0; u<n; ++u) {
+                    if (!in_tree[u] && (best_dist == INFTY || nearest_dist[u] < best_dist)) {
+                        v = u;
+                        best_dist = nearest_dist[u];
+                    }
                 }
-            }
-            if(best_dist >= join_threshold_max) { break; }
-
-            // 2) Join the 'next' cluster to the 'best' cluster
-            size_type next = nearest[best].first;
-            clusters[best].insert(clusters[next].begin(), clusters[next].end());
-            clusters[next].clear();
-
-            // 3) Recompute distances
-            nearest[next].first = -1;
-            nearest[next].second = INFTY;
-
-            size_type best_update = -1;
-            size_type best_update_dist = INFTY;
-            for (size_type i=0; i<n; ++i) {
-                if (i == best || i == next) { continue; }
-                if (dist[best][i] < best_update_dist) {
-                    best_update = i;
-                    best_update_dist = dist[best][i];
-                }
-                if (dist[next][i] < best_update_dist) {
-                    best_update = i;
-                    best_update_dist = dist[next][i];
+                if (best_dist < join_threshold_max) {
+                    size_type a = find_root(v), b = find_root(nearest[v]);
+                    parent[std::max(a, b)] = std::min(a, b);
                 }
             }
-            nearest[best].first = best_update;
-            nearest[best].second = best_update_dist;
-
-            for(size_type i=0; i<n; ++i) {
-                dist[next][i] = INFTY;
-                dist[i][next] = INFTY;
+            in_tree[v] = true;
+            for (size_type u=0; u<n; ++u) {
+                if (in_tree[u]) { continue; }
+                size_type d = dist.get(v, u);
+                if (d < nearest_dist[u]) {
+                    nearest_dist[u] = d;
+                    nearest[u] = v;
+                }
             }
         }
 
-        std::vector<cluster_type> non_empty_clusters;
-        for (size_type i=0; i<clusters.size(); ++i) {
-            if (!clusters[i].empty()) {
-                non_empty_clusters.push_back(clusters[i]);
+        // Clusters are listed in order of their first point
+        std::vector<cluster_type> clusters;
+        std::vector<size_type> cluster_of(n);
+        for (size_type i=0; i<n; ++i) {
+            size_type root = find_root(i);
+            if (root == i) {
+                cluster_of[i] = clusters.size();
+                clusters.emplace_back();
             }
+            clusters[cluster_of[root]].insert(clusters[cluster_of[root]].end(), i);
         }
-        return non_empty_clusters;
+        return clusters;
     }
 
     std::vector<size_type>
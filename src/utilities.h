@@ -5,11 +5,18 @@
 #define UTILITIES_H
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <exception>
+#include <mutex>
+#include <set>
+#include <thread>
 #include <vector>
 
+#include "condensed_matrix.h"
 #include "constants.h"
 #include "exception.h"
+#include "union_find.h"
 
 namespace retrocombinator
 {
@@ -31,11 +38,14 @@ namespace retrocombinator
         /// Type for a set of indices that represent a cluster
         typedef std::set<size_type> cluster_type;
 
-        /** Returns a set of clusters (using SLINK)
-         *  \param n the number of data points
-         *  \param dist the nXn distance matrix between the data points, the
-         *  distance between \c i and \c j is given by <tt>dist[i, j]</tt>, and
-         *  we assume <tt>dist[i, i] == 0</tt> for all \c i
+        /** Returns a set of clusters (using single linkage)
+         *  The clusters are found from a minimum spanning tree (Prim's
+         *  algorithm), in O(n^2) time and O(n) extra memory.
+         *  For when the distances are already at hand as a matrix. The
+         *  families of a pool are found with cluster_threshold() instead,
+         *  which gives the same clusters without needing a matrix.
+         *  \param dist the distance matrix between the data points, the
+         *  distance between \c i and \c j is given by <tt>dist.get(i, j)</tt>
          *  \param join_threshold_max we merge two for as long as the distance
          *  between them is < \a join_threshold_max (once the closest distance
          *  between two clusters becomes >= \a join_threshold_max this, we stop
@@ -43,9 +53,32 @@ namespace retrocombinator
          *  \return a sequence of clusters, where each cluster is a collection
          *  of indices belonging to it
          */
-        static std::vector<cluster_type> cluster_slink(dist_type dist, size_type n,
+        static std::vector<cluster_type> cluster_slink(const CondensedMatrix& dist,
                 size_type join_threshold_max);
 
+        /** Returns the same clusters as cluster_slink(), without a distance
+         *  matrix.
+         *  Single linkage clusters cut at a threshold are the connected
+         *  components of the graph that joins every two points closer than the
+         *  threshold. So the pairs of points are tested by \a close, split
+         *  over \a num_threads threads, and the pairs that pass are merged in
+         *  a shared UnionFind. Pairs that are already known to be in the same
+         *  cluster are not tested.
+         *  \param n the number of data points
+         *  \param close <tt>close(i, j)</tt> for <tt>i < j</tt> must return
+         *  whether the distance between \c i and \c j is < the threshold. It
+         *  is called from several threads at once, and can stop comparing as
+         *  soon as the threshold is reached
+         *  \param num_threads how many threads to use, 0 for as many as the
+         *  hardware supports. Small inputs are always clustered on the calling
+         *  thread
+         *  \return a sequence of clusters in order of their first point, where
+         *  each cluster is a collection of indices belonging to it
+         */
+        template <typename Close>
+        static std::vector<cluster_type> cluster_threshold(size_type n,
+                Close close, size_type num_threads = 0);
+
         /** Selects a representative from each cluster
           * \param clusters a sequence of clusters, where each cluster has all
           * the indices belonging to it
@@ -55,6 +88,65 @@ namespace retrocombinator
         select_representatives(std::vector<cluster_type> clusters);
 
     };
+
+    template <typename Close>
+    std::vector<Utils::cluster_type> Utils::cluster_threshold(size_type n,
+            Close close, size_type num_threads)
+    {
+        // not worth starting threads for fewer pairs than this
+        const size_type MIN_PAIRS_PER_THREAD = 4096;
+
+        if (num_threads == 0) {
+            num_threads = std::max<size_type>(1, std::thread::hardware_concurrency());
+        }
+        size_type num_pairs = n < 2 ? 0 : n * (n-1) / 2;
+        num_threads = std::max<size_type>(1,
+                std::min(num_threads, num_pairs / MIN_PAIRS_PER_THREAD));
+
+        UnionFind sets(n);
+        // rows are handed out one at a time, as they get shorter further down
+        std::atomic<size_type> next_row(0);
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto find_edges = [&]()
+        {
+            try {
+                for (size_type i = next_row++; i < n; i = next_row++) {
+                    for (size_type j = i+1; j < n; ++j) {
+                        if (!sets.same_set(i, j) && close(i, j)) {
+                            sets.unite(i, j);
+                        }
+                    }
+                }
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) { error = std::current_exception(); }
+                next_row = n;
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (size_type t=1; t<num_threads; ++t) {
+            workers.emplace_back(find_edges);
+        }
+        find_edges();
+        for (auto& worker : workers) { worker.join(); }
+        if (error) { std::rethrow_exception(error); }
+
+        // the root of every set is its first point
+        std::vector<cluster_type> clusters;
+        std::vector<size_type> cluster_of(n);
+        for (size_type i=0; i<n; ++i) {
+            size_type root = sets.find(i);
+            if (root == i) {
+                cluster_of[i] = clusters.size();
+                clusters.emplace_back();
+            }
+            clusters[cluster_of[root]].insert(clusters[cluster_of[root]].end(), i);
+        }
+        return clusters;
+    }
 }
 
 #endif // UTILITIES_H
@@ -0,0 +1,98 @@
+#include "weighted_sampler.h"
+
+#include <algorithm>
+
+using namespace retrocombinator;
+
+namespace
+{
+    /// The lowest set bit of \a i, the size of the block tree[i] covers
+    inline size_type lowbit(size_type i) { return i & (~i + 1); }
+}
+
+WeightedSampler::WeightedSampler(const std::vector<double>& weights) :
+    weights(weights), tree(weights.size() + 1, 0.0), top_step(1)
+{
+    // Build the tree in linear time, pushing each partial sum up to its parent
+    for (size_type i=1; i<=weights.size(); ++i)
+    {
+        if (weights[i-1] < 0) {
+            throw Exception("Event probabilities cannot be negative");
+        }
+        tree[i] += weights[i-1];
+        size_type parent = i + lowbit(i);
+        if (parent <= weights.size()) { tree[parent] += tree[i]; }
+    }
+    while (top_step * 2 <= weights.size()) { top_step *= 2; }
+    if (weights.empty()) { top_step = 0; }
+}
+
+void WeightedSampler::set_weight(size_type i, double weight)
+{
+    if (weight < 0) {
+        throw Exception("Event probabilities cannot be negative");
+    }
+    double change = weight - weights[i];
+    weights[i] = weight;
+    for (size_type j=i+1; j<tree.size(); j += lowbit(j))
+    {
+        tree[j] += change;
+    }
+}
+
+double WeightedSampler::prefix_total(size_type i) const
+{
+    double sum = 0;
+    for (; i>0; i -= lowbit(i))
+    {
+        sum += tree[i];
+    }
+    return sum;
+}
+
+size_type WeightedSampler::sample(double u) const
+{
+    double sum = total();
+    if (sum <= 0) {
+        throw Exception("Event probabilities add up to 0");
+    }
+    double target = u * sum;
+
+    // Find the first event whose cumulative weight passes the target, by
+    // walking down the tree and skipping every block that does not
+    size_type pos = 0;
+    for (size_type step=top_step; step>0; step /= 2)
+    {
+        if (pos + step < tree.size() && tree[pos + step] <= target)
+        {
+            pos += step;
+            target -= tree[pos];
+        }
+    }
+
+    // Rounding (here, or left in the tree by set_weight) can walk past the
+    // last event, or land on an event with no weight, so move to the nearest
+    // one that can be picked: the closest before it, or else after it
+    if (pos >= weights.size()) { pos = weights.size() - 1; }
+    for (size_type before = pos + 1; before > 0; --before)
+    {
+        if (weights[before - 1] > 0) { return before - 1; }
+    }
+    for (size_type after = pos + 1; after < weights.size(); ++after)
+    {
+        if (weights[after] > 0) { return after; }
+    }
+    throw Exception("Event probabilities add up to 0");
+}
+
+std::vector<size_type> WeightedSampler::sample_sorted(std::vector<double> us) const
+{
+    // Sampling is monotonic in u, so sorted values give sorted events
+    std::sort(us.begin(), us.end());
+    std::vector<size_type> events(us.size());
+    for (size_type k=0; k<us.size(); ++k)
+    {
+        events[k] = sample(us[k]);
+    }
+    return events;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file
+ *
+ * \brief For the WeightedSampler class, which samples from a discrete
+ * distribution whose weights can change between samples
+ */
+#ifndef WEIGHTED_SAMPLER_H
+#define WEIGHTED_SAMPLER_H
+
+#include "constants.h"
+
+#include <vector>
+
+namespace retrocombinator
+{
+    /** Samples events with *relative* probabilities (weights) that can be
+     *  changed between samples.
+     *
+     *  The weights are kept in a Fenwick (binary indexed) tree, so changing a
+     *  weight and drawing a sample both take O(log N) time for N events,
+     *  instead of the O(N) needed to rebuild cumulative sums. For weights
+     *  that never change, an AliasTable samples faster.
+     */
+    class WeightedSampler
+    {
+    private:
+        /// The weight of each event
+        std::vector<double> weights;
+        /** Fenwick tree of the weights, 1-indexed: tree[i] is the sum of the
+         *  weights of events [i - lowbit(i), i)
+         */
+        std::vector<double> tree;
+        /// The largest power of 2 that is at most the number of events
+        size_type top_step;
+
+    public:
+        /// No events, which cannot be sampled from
+        WeightedSampler() : tree(1, 0.0), top_step(0) {}
+
+        /** Events with the given weights.
+         *  Throws an exception if any of them are negative.
+         */
+        explicit WeightedSampler(const std::vector<double>& weights);
+
+        /// Returns the number of events
+        size_type size() const { return weights.size(); }
+
+        /// Returns the weight of event \a i
+        double get_weight(size_type i) const { return weights[i]; }
+
+        /** Sets the weight of event \a i.
+         *  Throws an exception if it is negative.
+         */
+        void set_weight(size_type i, double weight);
+
+        /// Returns the sum of the weights of events [0, \a i)
+        double prefix_total(size_type i) const;
+
+        /// Returns the sum of all the weights
+        double total() const { return prefix_total(weights.size()); }
+
+        /** Returns the event corresponding to the uniform value \a u in
+         *  [0, 1).
+         *  Events with weight 0 are never returned. Throws an exception if
+         *  all the weights are 0.
+         */
+        size_type sample(double u) const;
+
+        /** Returns the events corresponding to each of the uniform values in
+         *  \a us, in ascending order.
+         */
+        std::vector<size_type> sample_sorted(std::vector<double> us) const;
+    };
+}
+
+#endif // WEIGHTED_SAMPLER_H